@@ -0,0 +1,125 @@
+// CPU cost of the reassignment engine against the plain FFT at 8192, the
+// resolution it stands in for. Each case feeds ten seconds of a tone plus a
+// chirp through SpectralAnalyser::process() a block at a time, as the
+// analysis pool does, and takes the best of a few runs.
+
+#include "SpectralAnalyser.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int seconds = 10;
+    constexpr int blockSize = 1024;
+    constexpr int runs = 3;
+
+    struct Case
+    {
+        const char* name;
+        SpectralAnalyser::Engine engine;
+        int fftSize;
+        float overlap;
+    };
+
+    struct Result
+    {
+        double msPerSecond = 0.0;   // CPU time per second of audio
+        int framesPerSecond = 0;
+    };
+
+    std::vector<float> makeSignal()
+    {
+        const int length = static_cast<int>(sampleRate) * seconds;
+        std::vector<float> signal(static_cast<size_t>(length));
+
+        for (int i = 0; i < length; ++i)
+        {
+            const double t = i / sampleRate;
+            const double chirpPhase = 2.0 * juce::MathConstants<double>::pi * (200.0 * t + 400.0 * t * t);
+            signal[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(2.0 * juce::MathConstants<double>::pi * 1234.5 * t)
+                                                                + 0.1 * std::sin(chirpPhase));
+        }
+
+        return signal;
+    }
+
+    Result runOnce(const Case& c, const std::vector<float>& signal)
+    {
+        SpectralAnalyser analyser;
+        analyser.prepare(sampleRate, c.fftSize);
+        analyser.setOverlap(c.overlap);
+        analyser.setEngine(c.engine);
+        analyser.setDrainPolicy(SpectralAnalyser::DrainPolicy::catchUp, 0.5);
+
+        CaptureRing ring(2, 1 << 16);
+        const auto layout = analyser.getMonoLayout();
+        SpectralAnalyser::FrameView frame;
+
+        int numFrames = 0;
+        double elapsed = 0.0;
+
+        for (size_t offset = 0; offset + blockSize <= signal.size(); offset += blockSize)
+        {
+            const float* channels[] = { signal.data() + offset, signal.data() + offset };
+            ring.push(channels, blockSize);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            analyser.process(ring);
+            elapsed += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            while (analyser.acquireMonoFrame(frame, layout))
+            {
+                ++numFrames;
+                analyser.releaseMonoFrame();
+            }
+        }
+
+        return { elapsed * 1000.0 / seconds, numFrames / seconds };
+    }
+
+    Result run(const Case& c, const std::vector<float>& signal)
+    {
+        auto best = runOnce(c, signal);
+
+        for (int i = 1; i < runs; ++i)
+        {
+            const auto result = runOnce(c, signal);
+
+            if (result.msPerSecond < best.msPerSecond)
+                best = result;
+        }
+
+        return best;
+    }
+}
+
+int main()
+{
+    using Engine = SpectralAnalyser::Engine;
+
+    const Case baseline { "FFT 8192 @ 75%", Engine::fft, 8192, 0.75f };
+
+    const Case cases[] = { { "Reassign 1024 @ 50%", Engine::reassigned, 1024, 0.5f },
+                           { "Reassign 1024 @ 75%", Engine::reassigned, 1024, 0.75f },
+                           { "Reassign 2048 @ 50%", Engine::reassigned, 2048, 0.5f },
+                           { "Reassign 2048 @ 75%", Engine::reassigned, 2048, 0.75f } };
+
+    const auto signal = makeSignal();
+
+    std::printf("DSP kernels: %s\n\n", DspKernels::getName(DspKernels::get().isa));
+    std::printf("%-22s %10s %16s %12s\n", "", "frames/s", "ms CPU per s", "vs baseline");
+
+    const auto base = run(baseline, signal);
+    std::printf("%-22s %10d %16.2f %11.2fx\n", baseline.name, base.framesPerSecond, base.msPerSecond, 1.0);
+
+    for (const auto& c : cases)
+    {
+        const auto result = run(c, signal);
+        std::printf("%-22s %10d %16.2f %11.2fx\n", c.name, result.framesPerSecond, result.msPerSecond,
+                    result.msPerSecond / base.msPerSecond);
+    }
+
+    return 0;
+}
@@ -0,0 +1,451 @@
+#include "AnalysisPool.h"
+
+//==============================================================================
+AnalysisPool::InjectionQueue::InjectionQueue()
+{
+    for (size_t i = 0; i < capacity; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool AnalysisPool::InjectionQueue::push(uint64_t value) noexcept
+{
+    auto pos = enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[pos % capacity];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.value = value;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;   // full
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AnalysisPool::InjectionQueue::pop(uint64_t& value) noexcept
+{
+    auto pos = dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[pos % capacity];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                value = cell.value;
+                cell.sequence.store(pos + capacity, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;   // empty
+        }
+        else
+        {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//==============================================================================
+class AnalysisPool::Worker : public juce::Thread
+{
+public:
+    Worker(AnalysisPool& ownerPool, int workerIndex)
+        : juce::Thread("Spectrogram analysis " + juce::String(workerIndex + 1)),
+          pool(ownerPool), index(workerIndex)
+    {
+    }
+
+    ~Worker() override { stop(); }
+
+    void stop()
+    {
+        signalThreadShouldExit();
+        wakeSignal.signal();
+        stopThread(2000);
+    }
+
+    void wake() noexcept { wakeSignal.signal(); }
+
+    bool popLocal(Level level, uint64_t& entry)
+    {
+        const juce::SpinLock::ScopedLockType sl(localLock);
+        auto& queue = local[level];
+
+        if (queue.empty())
+            return false;
+
+        entry = queue.front();
+        queue.pop_front();
+        return true;
+    }
+
+    bool steal(Level level, uint64_t& entry)
+    {
+        const juce::SpinLock::ScopedLockType sl(localLock);
+        auto& queue = local[level];
+
+        if (queue.empty())
+            return false;
+
+        entry = queue.back();
+        queue.pop_back();
+        return true;
+    }
+
+    void pushLocal(Level level, uint64_t entry)
+    {
+        const juce::SpinLock::ScopedLockType sl(localLock);
+        local[level].push_back(entry);
+    }
+
+    int consecutiveForeground = 0;
+
+private:
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            uint64_t entry;
+
+            if (pool.findJob(index, entry))
+            {
+                pool.runJob(entry);
+                continue;
+            }
+
+            // Announce we're idle, then look once more so a submit that raced
+            // with the first look isn't left waiting for the timeout
+            pool.setIdle(index, true);
+
+            if (pool.findJob(index, entry))
+            {
+                pool.setIdle(index, false);
+                pool.runJob(entry);
+                continue;
+            }
+
+            wakeSignal.wait(idleTimeoutMs);
+            pool.setIdle(index, false);
+        }
+    }
+
+    static constexpr int idleTimeoutMs = 100;
+
+    AnalysisPool& pool;
+    const int index;
+
+    WakeSignal wakeSignal;
+
+    juce::SpinLock localLock;
+    std::deque<uint64_t> local[numLevels];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker)
+};
+
+//==============================================================================
+AnalysisPool::AnalysisPool()
+{
+    // Leave a core for the audio and message threads
+    const int numWorkers = juce::jlimit(1, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(*this, i));
+
+    startWorkers();
+}
+
+AnalysisPool::~AnalysisPool()
+{
+    stopWorkers();
+}
+
+void AnalysisPool::startWorkers()
+{
+    for (auto& worker : workers)
+        worker->startThread(workerPriority);
+}
+
+void AnalysisPool::stopWorkers()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+        worker->stop();
+
+    idleWorkers.store(0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+AnalysisPool::Handle AnalysisPool::addClient(Job job, bool isForeground)
+{
+    const juce::ScopedLock sl(clientLock);
+
+    for (int i = 0; i < maxClients; ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+        if (slot.inUse)
+            continue;
+
+        slot.inUse = true;
+        slot.job = std::move(job);
+        slot.foreground.store(isForeground, std::memory_order_relaxed);
+        slot.queueDepth.store(0, std::memory_order_relaxed);
+        slot.peakQueueDepth.store(0, std::memory_order_relaxed);
+        slot.jobsRun.store(0, std::memory_order_relaxed);
+        slot.framesAnalysed.store(0, std::memory_order_relaxed);
+
+        // Publishes the job to any worker that later sees this generation
+        const auto generation = generationOf(slot.state.load(std::memory_order_relaxed));
+        slot.state.store(packState(generation, idle), std::memory_order_release);
+
+        return { i, generation };
+    }
+
+    jassertfalse;   // more than maxClients instances in one process
+    return {};
+}
+
+void AnalysisPool::removeClient(Handle& handle)
+{
+    if (!handle.isValid())
+        return;
+
+    const juce::ScopedLock sl(clientLock);
+    auto& slot = slots[static_cast<size_t>(handle.slot)];
+
+    for (;;)
+    {
+        auto word = slot.state.load(std::memory_order_acquire);
+        jassert(generationOf(word) == handle.generation);
+
+        const auto runState = runStateOf(word);
+        if (runState == running || runState == runningRequeue)
+        {
+            juce::Thread::sleep(1);
+            continue;
+        }
+
+        // Any queued entry now refers to a dead generation and is dropped
+        if (slot.state.compare_exchange_weak(word, packState(handle.generation + 1, idle),
+                                             std::memory_order_acq_rel))
+            break;
+    }
+
+    slot.job = nullptr;
+    slot.inUse = false;
+    handle = {};
+}
+
+void AnalysisPool::setForeground(Handle handle, bool isForeground) noexcept
+{
+    if (handle.isValid())
+        slots[static_cast<size_t>(handle.slot)].foreground.store(isForeground, std::memory_order_relaxed);
+}
+
+AnalysisPool::Metrics AnalysisPool::getMetrics(Handle handle) const noexcept
+{
+    if (!handle.isValid())
+        return {};
+
+    const auto& slot = slots[static_cast<size_t>(handle.slot)];
+
+    Metrics metrics;
+    metrics.queueDepth = slot.queueDepth.load(std::memory_order_relaxed);
+    metrics.peakQueueDepth = slot.peakQueueDepth.load(std::memory_order_relaxed);
+    metrics.jobsRun = slot.jobsRun.load(std::memory_order_relaxed);
+    metrics.framesAnalysed = slot.framesAnalysed.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+//==============================================================================
+void AnalysisPool::submit(Handle handle) noexcept
+{
+    if (!handle.isValid())
+        return;
+
+    auto& slot = slots[static_cast<size_t>(handle.slot)];
+    slot.queueDepth.fetch_add(1, std::memory_order_relaxed);
+
+    auto word = slot.state.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        if (generationOf(word) != handle.generation)
+            return;
+
+        const auto runState = runStateOf(word);
+        if (runState == queued || runState == runningRequeue)
+            return;
+
+        // Idle: queue it. Running: have the worker queue it again when it's done.
+        const auto next = runState == idle ? queued : runningRequeue;
+
+        if (slot.state.compare_exchange_weak(word, packState(handle.generation, next),
+                                             std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            if (runState == idle)
+                enqueue(handle.slot, handle.generation);
+
+            return;
+        }
+    }
+}
+
+void AnalysisPool::enqueue(int slotIndex, uint32_t generation) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(slotIndex)];
+    const auto level = slot.foreground.load(std::memory_order_relaxed) ? foreground : background;
+
+    if (!injection[level].push(packEntry(slotIndex, generation)))
+    {
+        // Can't happen while every client is queued at most once; if it
+        // somehow does, back off and let the next submit try again
+        jassertfalse;
+        auto expected = packState(generation, queued);
+        slot.state.compare_exchange_strong(expected, packState(generation, idle), std::memory_order_acq_rel);
+        return;
+    }
+
+    wakeIdleWorker();
+}
+
+void AnalysisPool::setIdle(int workerIndex, bool isIdle) noexcept
+{
+    const auto bit = 1u << workerIndex;
+
+    if (isIdle)
+        idleWorkers.fetch_or(bit, std::memory_order_acq_rel);
+    else
+        idleWorkers.fetch_and(~bit, std::memory_order_acq_rel);
+}
+
+void AnalysisPool::wakeIdleWorker() noexcept
+{
+    auto mask = idleWorkers.load(std::memory_order_acquire);
+
+    while (mask != 0)
+    {
+        int index = 0;
+        while ((mask & (1u << index)) == 0)
+            ++index;
+
+        if (idleWorkers.compare_exchange_weak(mask, mask & ~(1u << index), std::memory_order_acq_rel))
+        {
+            workers[static_cast<size_t>(index)]->wake();
+            return;
+        }
+    }
+}
+
+//==============================================================================
+bool AnalysisPool::findJob(int workerIndex, uint64_t& entry)
+{
+    auto& worker = *workers[static_cast<size_t>(workerIndex)];
+
+    // Starvation guard: after a run of foreground jobs, look at background first
+    const bool backgroundFirst = worker.consecutiveForeground >= foregroundBurst;
+    const Level order[] = { backgroundFirst ? background : foreground,
+                            backgroundFirst ? foreground : background };
+
+    for (auto level : order)
+    {
+        if (takeJob(workerIndex, level, entry))
+        {
+            worker.consecutiveForeground = level == foreground ? worker.consecutiveForeground + 1 : 0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AnalysisPool::takeJob(int workerIndex, Level level, uint64_t& entry)
+{
+    auto& worker = *workers[static_cast<size_t>(workerIndex)];
+
+    if (worker.popLocal(level, entry))
+        return true;
+
+    // Take one to run plus a small batch to keep locally, so workers don't all
+    // hammer the injection queue; idle ones can steal the batch
+    if (injection[level].pop(entry))
+    {
+        constexpr int batchSize = 4;
+        bool parkedAny = false;
+
+        for (int i = 1; i < batchSize; ++i)
+        {
+            uint64_t extra;
+            if (!injection[level].pop(extra))
+                break;
+
+            worker.pushLocal(level, extra);
+            parkedAny = true;
+        }
+
+        if (parkedAny)
+            wakeIdleWorker();
+
+        return true;
+    }
+
+    const int numWorkers = getNumWorkers();
+    for (int i = 1; i < numWorkers; ++i)
+        if (workers[static_cast<size_t>((workerIndex + i) % numWorkers)]->steal(level, entry))
+            return true;
+
+    return false;
+}
+
+void AnalysisPool::runJob(uint64_t entry)
+{
+    const auto slotIndex = static_cast<int>(entry & 0xffffffffu);
+    const auto generation = static_cast<uint32_t>(entry >> 32);
+    auto& slot = slots[static_cast<size_t>(slotIndex)];
+
+    // Fails for entries left behind by a removed client
+    auto expected = packState(generation, queued);
+    if (!slot.state.compare_exchange_strong(expected, packState(generation, running), std::memory_order_acq_rel))
+        return;
+
+    const int depth = slot.queueDepth.exchange(0, std::memory_order_relaxed);
+    int peak = slot.peakQueueDepth.load(std::memory_order_relaxed);
+    while (depth > peak && !slot.peakQueueDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+
+    const int frames = slot.job();
+
+    slot.jobsRun.fetch_add(1, std::memory_order_relaxed);
+    slot.framesAnalysed.fetch_add(static_cast<uint64_t>(frames), std::memory_order_relaxed);
+
+    // Submitted again while running: go to the back of the queue
+    expected = packState(generation, running);
+    if (!slot.state.compare_exchange_strong(expected, packState(generation, idle), std::memory_order_acq_rel))
+    {
+        jassert(runStateOf(expected) == runningRequeue);
+        slot.state.store(packState(generation, queued), std::memory_order_release);
+        enqueue(slotIndex, generation);
+    }
+}
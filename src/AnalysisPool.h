@@ -0,0 +1,162 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "WakeSignal.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Process-wide analysis scheduler shared by every plugin instance through
+// juce::SharedResourcePointer<AnalysisPool>. A fixed set of worker threads
+// serves all instances, so 80 instances in a template cost a handful of
+// threads rather than 80, and their FFTs run in parallel across cores.
+//
+// Each instance registers one job: "analyse whatever input is ready". The
+// audio thread submits it once a frame is waiting. A client is queued at most
+// once and never runs on two workers at the same time; a submit that arrives
+// mid-run queues it again behind everyone else.
+//
+// Scheduling:
+//  - Submits land in a lock-free injection queue per priority level, so
+//    processBlock never takes a lock.
+//  - A worker pulls a small batch from the injection queue into its own
+//    deque and works from the front; idle workers steal from the back of
+//    other workers' deques.
+//  - Clients with an open editor are foreground and are served first.
+//    Hidden ones are background, best-effort, but after foregroundBurst
+//    foreground jobs in a row a worker takes a background job if there is
+//    one, so they can't starve.
+class AnalysisPool
+{
+public:
+    // Analyses everything that's ready and returns the number of frames produced
+    using Job = std::function<int()>;
+
+    struct Handle
+    {
+        int slot = -1;
+        uint32_t generation = 0;
+
+        bool isValid() const noexcept { return slot >= 0; }
+    };
+
+    struct Metrics
+    {
+        int queueDepth = 0;             // frame-ready submits not yet picked up by a worker
+        int peakQueueDepth = 0;         // largest depth a worker has found on pick-up
+        uint64_t jobsRun = 0;
+        uint64_t framesAnalysed = 0;
+    };
+
+    static constexpr int maxClients = 256;
+    static constexpr int maxWorkers = 16;
+    static constexpr int foregroundBurst = 4;
+
+    AnalysisPool();
+    ~AnalysisPool();
+
+    // Returns an invalid handle if all maxClients slots are taken
+    Handle addClient(Job job, bool foreground);
+
+    // Waits for a run already in progress to finish; the job never runs again
+    // afterwards. Resets the handle.
+    void removeClient(Handle& handle);
+
+    void setForeground(Handle handle, bool foreground) noexcept;
+
+    // Lock-free and non-blocking: safe to call from processBlock
+    void submit(Handle handle) noexcept;
+
+    Metrics getMetrics(Handle handle) const noexcept;
+
+    int getNumWorkers() const noexcept { return static_cast<int>(workers.size()); }
+
+private:
+    enum Level { foreground = 0, background = 1, numLevels = 2 };
+
+    // A slot's state word: generation in the high 32 bits, RunState in the low.
+    // Removing a client bumps the generation, which invalidates any queued
+    // entries for it without having to find them.
+    enum RunState : uint32_t { idle, queued, running, runningRequeue };
+
+    static uint64_t packState(uint32_t generation, RunState runState) noexcept
+    {
+        return (static_cast<uint64_t>(generation) << 32) | runState;
+    }
+
+    static uint32_t generationOf(uint64_t word) noexcept { return static_cast<uint32_t>(word >> 32); }
+    static RunState runStateOf(uint64_t word) noexcept  { return static_cast<RunState>(word & 0xffffffffu); }
+
+    // Queue entries are (slot, generation) packed the same way
+    static uint64_t packEntry(int slot, uint32_t generation) noexcept
+    {
+        return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(slot);
+    }
+
+    struct Slot
+    {
+        std::atomic<uint64_t> state{0};
+        std::atomic<bool> foreground{false};
+        bool inUse = false;     // guarded by clientLock
+        Job job;
+
+        std::atomic<int> queueDepth{0};
+        std::atomic<int> peakQueueDepth{0};
+        std::atomic<uint64_t> jobsRun{0};
+        std::atomic<uint64_t> framesAnalysed{0};
+    };
+
+    // Bounded multi-producer/multi-consumer queue (Vyukov): one CAS per push
+    // or pop, no locks, no allocation
+    class InjectionQueue
+    {
+    public:
+        InjectionQueue();
+
+        bool push(uint64_t value) noexcept;
+        bool pop(uint64_t& value) noexcept;
+
+    private:
+        // A client is queued at most once at a time; stale entries from removed
+        // clients can add at most one more each
+        static constexpr size_t capacity = 2 * maxClients;
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            uint64_t value;
+        };
+
+        std::array<Cell, capacity> cells;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) std::atomic<size_t> dequeuePos{0};
+    };
+
+    class Worker;
+
+    bool findJob(int workerIndex, uint64_t& entry);
+    bool takeJob(int workerIndex, Level level, uint64_t& entry);
+    void runJob(uint64_t entry);
+    void enqueue(int slot, uint32_t generation) noexcept;
+
+    void setIdle(int workerIndex, bool isIdle) noexcept;
+    void wakeIdleWorker() noexcept;
+
+    void startWorkers();
+    void stopWorkers();
+
+    std::array<Slot, maxClients> slots;
+    InjectionQueue injection[numLevels];
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint32_t> idleWorkers{0};   // one bit per worker
+
+    juce::CriticalSection clientLock;
+
+    static constexpr juce::Thread::Priority workerPriority = juce::Thread::Priority::high;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisPool)
+};
@@ -0,0 +1,272 @@
+#include "BandZoom.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // The final band stays within this fraction of the output rate either
+    // side of DC; the rest is the last filter's transition
+    constexpr double passbandFraction = 0.4;
+
+    constexpr int zeroPadding = 4;
+
+    std::atomic<uint64_t> nextPlanId{ 1 };
+}
+
+std::shared_ptr<const BandZoom::Plan> BandZoom::createPlan(double sampleRate, int windowLength,
+                                                          double minHz, double maxHz,
+                                                          WindowBank::Type windowType)
+{
+    jassert(sampleRate > 0.0 && windowLength > 0 && windowLength <= maxWindowLength);
+
+    auto plan = std::make_shared<Plan>();
+    plan->id = nextPlanId.fetch_add(1);
+    plan->sampleRate = sampleRate;
+
+    const double nyquist = sampleRate * 0.5;
+    maxHz = juce::jlimit(1.0, nyquist, maxHz);
+    minHz = juce::jlimit(0.0, maxHz - 1.0, minHz);
+
+    const double bandwidth = maxHz - minHz;
+    plan->centreHz = 0.5 * (minHz + maxHz);
+
+    // As many halvings as keep the band inside the passband and leave enough
+    // decimated samples per window
+    int numStages = 0;
+
+    while (numStages < maxStages)
+    {
+        const int factor = 1 << (numStages + 1);
+
+        if (sampleRate / factor * 2.0 * passbandFraction < bandwidth
+            || windowLength % factor != 0
+            || windowLength / factor < minHistoryLength)
+            break;
+
+        ++numStages;
+    }
+
+    plan->numStages = numStages;
+    const int decimation = 1 << numStages;
+
+    for (int s = 0; s < numStages; ++s)
+        plan->stageTaps[static_cast<size_t>(s)] = HalfBandDecimator::design(passbandFraction / (1 << (numStages - s)));
+
+    plan->historyLength = windowLength / decimation;
+    plan->transformSize = juce::jmin(maxWindowLength, juce::nextPowerOfTwo(plan->historyLength * zeroPadding));
+
+    const double binHz = sampleRate / decimation / plan->transformSize;
+    const int firstBin = static_cast<int>(std::ceil((minHz - plan->centreHz) / binHz));
+    const int lastBin = static_cast<int>(std::floor((maxHz - plan->centreHz) / binHz));
+
+    plan->firstBin = firstBin;
+    plan->layout.numBins = lastBin - firstBin + 1;
+    plan->layout.minHz = plan->centreHz + firstBin * binHz;
+    plan->layout.maxHz = plan->centreHz + lastBin * binHz;
+
+    const double phaseStep = -juce::MathConstants<double>::twoPi * plan->centreHz / sampleRate;
+
+    for (int j = 0; j < oscillatorLanes; ++j)
+        plan->oscillatorSteps[static_cast<size_t>(j)] = std::polar(1.0, phaseStep * j);
+
+    plan->oscillatorAdvance = std::polar(1.0, phaseStep * oscillatorLanes);
+
+    plan->window = WindowBank::get(windowType, plan->historyLength);
+    plan->fft = FFTBackends::createFastest(plan->transformSize);
+
+    // The heterodyned tone keeps half the real one's amplitude, as a real
+    // transform's positive-frequency bin does, so only the window's length
+    // and gain need normalising
+    const auto hann = WindowBank::get(WindowBank::Type::hann, plan->historyLength);
+    plan->normalisationDb = 20.0f * std::log10(hann->coherentGain / plan->window->coherentGain)
+                          - 20.0f * std::log10(static_cast<float>(plan->historyLength));
+
+    return plan;
+}
+
+//==============================================================================
+BandZoom::BandZoom()
+{
+    for (size_t i = 0; i < 2; ++i)
+    {
+        scratchRe[i].resize(maxWindowLength);
+        scratchIm[i].resize(maxWindowLength);
+    }
+
+    historyRe.resize(2 * maxWindowLength);
+    historyIm.resize(2 * maxWindowLength);
+
+    transformIn.resize(maxWindowLength);
+    transformOut.resize(maxWindowLength);
+
+    reset();
+}
+
+void BandZoom::prepare(const Plan& plan) noexcept
+{
+    if (plan.id == preparedPlanId)
+        return;
+
+    reset();
+    preparedPlanId = plan.id;
+}
+
+void BandZoom::reset() noexcept
+{
+    for (auto& stage : stages)
+    {
+        stage.re.reset();
+        stage.im.reset();
+    }
+
+    std::fill(historyRe.begin(), historyRe.end(), 0.0f);
+    std::fill(historyIm.begin(), historyIm.end(), 0.0f);
+    historyPos = 0;
+
+    oscillator = { 1.0, 0.0 };
+}
+
+void BandZoom::push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int num = juce::jmin(maxWindowLength, numSamples - done);
+        pushBlock(plan, left + done, right != nullptr ? right + done : nullptr, num);
+        done += num;
+    }
+}
+
+void BandZoom::pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept
+{
+    float* re = scratchRe[0].data();
+    float* im = scratchIm[0].data();
+
+    // The second scratch pair is free until the first stage writes to it
+    heterodyne(plan, left, right, re, im, scratchRe[1].data(), scratchIm[1].data(), num);
+
+    for (int s = 0; s < plan.numStages; ++s)
+    {
+        const size_t out = (static_cast<size_t>(s) + 1) & 1;
+        auto& stage = stages[static_cast<size_t>(s)];
+        const auto& taps = plan.stageTaps[static_cast<size_t>(s)];
+
+        stage.re.process(taps, re, num, scratchRe[out].data());
+        num = stage.im.process(taps, im, num, scratchIm[out].data());
+        re = scratchRe[out].data();
+        im = scratchIm[out].data();
+    }
+
+    const int length = plan.historyLength;
+
+    for (int i = 0; i < num; ++i)
+    {
+        historyRe[static_cast<size_t>(historyPos)] = historyRe[static_cast<size_t>(historyPos + length)] = re[i];
+        historyIm[static_cast<size_t>(historyPos)] = historyIm[static_cast<size_t>(historyPos + length)] = im[i];
+
+        if (++historyPos == length)
+            historyPos = 0;
+    }
+}
+
+void BandZoom::heterodyne(const Plan& plan, const float* left, const float* right,
+                          float* re, float* im, float* phasorRe, float* phasorIm, int num) noexcept
+{
+    // Shift the band centre to DC. The phasor is stepped in double precision
+    // by oscillatorLanes independent rotations, each a step apart and
+    // advancing by step^oscillatorLanes, so consecutive samples don't wait on
+    // each other; the products are written out rather than using
+    // std::complex's operator*, which goes through a library call to handle
+    // infinities.
+    double laneRe[oscillatorLanes], laneIm[oscillatorLanes];
+
+    for (int j = 0; j < oscillatorLanes; ++j)
+    {
+        const auto& p = plan.oscillatorSteps[static_cast<size_t>(j)];
+        laneRe[j] = oscillator.real() * p.real() - oscillator.imag() * p.imag();
+        laneIm[j] = oscillator.real() * p.imag() + oscillator.imag() * p.real();
+    }
+
+    const double advanceRe = plan.oscillatorAdvance.real(), advanceIm = plan.oscillatorAdvance.imag();
+    int i = 0;
+
+    for (; i + oscillatorLanes <= num; i += oscillatorLanes)
+    {
+        for (int j = 0; j < oscillatorLanes; ++j)
+        {
+            phasorRe[i + j] = static_cast<float>(laneRe[j]);
+            phasorIm[i + j] = static_cast<float>(laneIm[j]);
+
+            const double nextRe = laneRe[j] * advanceRe - laneIm[j] * advanceIm;
+            laneIm[j] = laneRe[j] * advanceIm + laneIm[j] * advanceRe;
+            laneRe[j] = nextRe;
+        }
+    }
+
+    // The first lane is now on sample i
+    double oscRe = laneRe[0], oscIm = laneIm[0];
+    const double stepRe = plan.oscillatorSteps[1].real(), stepIm = plan.oscillatorSteps[1].imag();
+
+    for (; i < num; ++i)
+    {
+        phasorRe[i] = static_cast<float>(oscRe);
+        phasorIm[i] = static_cast<float>(oscIm);
+
+        const double nextRe = oscRe * stepRe - oscIm * stepIm;
+        oscIm = oscRe * stepIm + oscIm * stepRe;
+        oscRe = nextRe;
+    }
+
+    // Keep the rotation from drifting off the unit circle
+    const double magnitude = std::sqrt(oscRe * oscRe + oscIm * oscIm);
+    oscillator = { oscRe / magnitude, oscIm / magnitude };
+
+    const auto& kernels = DspKernels::get();
+    const float* mono = left;
+
+    if (right != nullptr)
+    {
+        kernels.mixToMono(re, left, right, num);
+        mono = re;
+    }
+
+    kernels.applyWindow(im, mono, phasorIm, num);
+    kernels.applyWindow(re, mono, phasorRe, num);
+}
+
+void BandZoom::analyse(const Plan& plan, float* destDb) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    const auto& kernels = DspKernels::get();
+    const int length = plan.historyLength;
+    const int size = plan.transformSize;
+    auto* in = reinterpret_cast<float*>(transformIn.data());
+
+    // Oldest to newest starts at the write position
+    kernels.applyWindowPair(in, historyRe.data() + historyPos, historyIm.data() + historyPos,
+                            plan.window->data, length);
+    std::fill(transformIn.begin() + length, transformIn.begin() + size, FFTBackend::Complex{});
+
+    plan.fft->performForward(transformIn.data(), transformOut.data());
+
+    // Bins below the centre wrap around to the top of the transform
+    const auto* bins = reinterpret_cast<const float*>(transformOut.data());
+    const int numBins = plan.layout.numBins;
+    int written = 0;
+
+    if (plan.firstBin < 0)
+    {
+        written = juce::jmin(-plan.firstBin, numBins);
+        kernels.complexToDb(bins + 2 * (size + plan.firstBin), destDb, written, plan.normalisationDb);
+    }
+
+    if (written < numBins)
+    {
+        const int start = juce::jmax(0, plan.firstBin);
+        kernels.complexToDb(bins + 2 * start, destDb + written, numBins - written, plan.normalisationDb);
+    }
+}
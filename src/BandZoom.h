@@ -0,0 +1,121 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "BinLayout.h"
+#include "FFTBackend.h"
+#include "HalfBandDecimator.h"
+#include "WindowBank.h"
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Band-limited ("zoom") analysis. Instead of transforming the whole band and
+// throwing most of the bins away, the input is shifted so the zoom range sits
+// around DC, decimated by 2 per stage with a cascade of half-band filters,
+// and only the decimated stream is windowed and transformed.
+//
+// The window still spans windowLength input samples, so the frequency
+// resolution matches a full-band FFT of that size, but the transform is
+// windowLength / decimation points (zero-padded 4x so peaks stay sharp on
+// screen), and the heterodyne and filters run once per input sample rather
+// than once per overlapping frame. Early stages only have to protect the
+// final band, so their filters are a handful of taps; only the last one is
+// sharp.
+//
+// The stream is continuous across hops: each call to push() consumes new
+// input, and analyse() transforms the latest window of decimated history.
+class BandZoom
+{
+public:
+    static constexpr int maxWindowLength = 8192;
+    static constexpr int maxStages = 8;
+
+    // Fewer decimated samples per window than this isn't worth the filters
+    static constexpr int minHistoryLength = 32;
+
+    // Phasors the oscillator runs side by side
+    static constexpr int oscillatorLanes = 8;
+
+    // Immutable once built; shared through the analyser's published Config
+    struct Plan
+    {
+        uint64_t id = 0;
+
+        double sampleRate = 0.0;
+        double centreHz = 0.0;
+        int numStages = 0;
+        int historyLength = 0;      // decimated samples per window
+        int transformSize = 0;      // complex FFT size, >= historyLength
+
+        // Signed transform bin of output bin 0; negative bins lie below the
+        // centre frequency
+        int firstBin = 0;
+        BinLayout layout;
+
+        // Odd-indexed taps h[1], h[3], ... of each stage's symmetric half-band
+        // filter; h[0] is always 0.5 and the even taps are zero
+        std::array<std::vector<float>, maxStages> stageTaps;
+
+        // exp(-i 2 pi centreHz j / sampleRate) for j = 0 .. oscillatorLanes - 1,
+        // and the same for j = oscillatorLanes
+        std::array<std::complex<double>, oscillatorLanes> oscillatorSteps;
+        std::complex<double> oscillatorAdvance;
+
+        std::shared_ptr<const WindowBank::Table> window;
+        std::shared_ptr<FFTBackend> fft;
+
+        // Scales a bin to the level a full-band transform of the same window
+        // would report, calibrated to Hann like the analyser's own frames
+        float normalisationDb = 0.0f;
+    };
+
+    // windowLength is the equivalent full-band FFT size. The band is clamped
+    // to (0, Nyquist].
+    static std::shared_ptr<const Plan> createPlan(double sampleRate, int windowLength,
+                                                  double minHz, double maxHz,
+                                                  WindowBank::Type windowType);
+
+    // Allocates for the largest plan; nothing allocates afterwards
+    BandZoom();
+
+    // Clears the filters and history when plan isn't the one the state was
+    // built for; otherwise does nothing
+    void prepare(const Plan& plan) noexcept;
+
+    // Forgets everything, e.g. after input was skipped
+    void reset() noexcept;
+
+    // Feeds new input through the oscillator and decimators. right may be
+    // nullptr for mono input; otherwise the two are mixed down.
+    void push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept;
+
+    // Transforms the latest window into plan.layout.numBins dB values
+    void analyse(const Plan& plan, float* destDb) noexcept;
+
+private:
+    // One decimation stage filters the real and imaginary parts alike
+    struct Stage
+    {
+        HalfBandDecimator re, im;
+    };
+
+    void pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept;
+    void heterodyne(const Plan& plan, const float* left, const float* right,
+                    float* re, float* im, float* phasorRe, float* phasorIm, int num) noexcept;
+
+    std::array<Stage, maxStages> stages;
+    std::array<std::vector<float>, 2> scratchRe, scratchIm;
+
+    // Decimated history, written twice historyLength apart so the latest
+    // window is always contiguous from historyPos
+    std::vector<float> historyRe, historyIm;
+    int historyPos = 0;
+
+    std::complex<double> oscillator{ 1.0, 0.0 };
+
+    std::vector<FFTBackend::Complex> transformIn, transformOut;
+
+    uint64_t preparedPlanId = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+
+// Where the bins of an analysed frame sit in frequency. A full-band FFT frame
+// runs linearly from 0 Hz to Nyquist; a band-limited one covers only the
+// zoomed range. The editor maps display frequencies through this rather than
+// assuming bin / (numBins - 1) * Nyquist.
+struct BinLayout
+{
+    int numBins = 0;
+    double minHz = 0.0;     // centre of bin 0
+    double maxHz = 0.0;     // centre of the last bin
+    bool logSpaced = false; // geometric rather than linear spacing
+
+    double binToHz(double bin) const noexcept
+    {
+        if (numBins < 2)
+            return minHz;
+
+        const double t = bin / static_cast<double>(numBins - 1);
+        return logSpaced ? minHz * std::pow(maxHz / minHz, t)
+                         : minHz + (maxHz - minHz) * t;
+    }
+
+    // Fractional bin index; outside [0, numBins - 1] for frequencies the
+    // frame doesn't cover
+    double hzToBin(double hz) const noexcept
+    {
+        if (numBins < 2 || maxHz <= minHz)
+            return 0.0;
+
+        if (logSpaced && hz <= 0.0)
+            return -1.0;
+
+        const double t = logSpaced ? std::log(hz / minHz) / std::log(maxHz / minHz)
+                                   : (hz - minHz) / (maxHz - minHz);
+        return t * static_cast<double>(numBins - 1);
+    }
+
+    // Exact: layouts are compared to spot a change, not closeness.
+    // std::equal_to says so without -Wfloat-equal, as juce::exactlyEqual does.
+    bool operator==(const BinLayout& other) const noexcept
+    {
+        const std::equal_to<double> exactlyEqual;
+
+        return numBins == other.numBins && exactlyEqual(minHz, other.minHz)
+            && exactlyEqual(maxHz, other.maxHz) && logSpaced == other.logSpaced;
+    }
+
+    bool operator!=(const BinLayout& other) const noexcept { return !(*this == other); }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
+#include <cstdint>
+
+// Single-producer / single-consumer capture ring for the raw input channels.
+//
+// Each channel has its own plane, but all planes share one write and one read
+// index, so the channels can never drift apart: a push or discard moves every
+// channel at once. The audio thread does nothing but one memcpy per channel
+// (JUCE hands it planar buffers already); mixdown and channel splitting
+// happen on the consumer side. The consumer peeks at the oldest samples as a
+// region that may wrap once, the same for every channel, and discards fewer
+// than it looked at, so overlapping FFT frames are read straight out of the
+// ring.
+//
+// Capacity is a power of two, and the two indices sit on separate cache
+// lines so producer and consumer don't false-share.
+class CaptureRing
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    struct Span
+    {
+        const float* data = nullptr;
+        int size = 0;
+    };
+
+    // The oldest samples of one peek: [start, start + size1) followed, if the
+    // range wraps, by [0, size2), in every channel
+    struct Region
+    {
+        int start = 0;
+        int size1 = 0;
+        int size2 = 0;
+
+        int getTotalSize() const noexcept { return size1 + size2; }
+    };
+
+    CaptureRing(int numChannels, int capacity)
+    {
+        setSize(numChannels, capacity);
+    }
+
+    // Not thread-safe: only while neither side is running
+    void setSize(int newNumChannels, int newCapacity)
+    {
+        jassert(newNumChannels >= 1 && newNumChannels <= maxChannels);
+
+        const int size = juce::nextPowerOfTwo(juce::jmax(1, newCapacity));
+        buffer.setSize(newNumChannels, size);
+        buffer.clear();
+        mask = static_cast<uint32_t>(size - 1);
+        reset();
+    }
+
+    void reset()
+    {
+        writeCount.store(0, std::memory_order_relaxed);
+        readCount.store(0, std::memory_order_relaxed);
+        overflowedSamples.store(0, std::memory_order_relaxed);
+        overflowEvents.store(0, std::memory_order_relaxed);
+    }
+
+    int getNumChannels() const noexcept { return buffer.getNumChannels(); }
+    int getCapacity() const noexcept { return static_cast<int>(mask + 1); }
+    int getFreeSpace() const noexcept { return getCapacity() - getNumReady(); }
+
+    int getNumReady() const noexcept
+    {
+        return static_cast<int>(writeCount.load(std::memory_order_acquire)
+                                - readCount.load(std::memory_order_acquire));
+    }
+
+    // Producer. channels holds getNumChannels() pointers. Whatever doesn't
+    // fit is dropped and counted as an overflow.
+    void push(const float* const* channels, int numSamples) noexcept
+    {
+        const uint32_t w = writeCount.load(std::memory_order_relaxed);
+        const uint32_t r = readCount.load(std::memory_order_acquire);
+        const int toWrite = juce::jmin(numSamples, getCapacity() - static_cast<int>(w - r));
+
+        if (toWrite < numSamples)
+        {
+            overflowedSamples.fetch_add(static_cast<uint64_t>(numSamples - juce::jmax(0, toWrite)), std::memory_order_relaxed);
+            overflowEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (toWrite <= 0)
+            return;
+
+        const int start = static_cast<int>(w & mask);
+        const int size1 = juce::jmin(toWrite, getCapacity() - start);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* dest = buffer.getWritePointer(ch);
+            std::memcpy(dest + start, channels[ch], sizeof(float) * (size_t)size1);
+
+            if (toWrite > size1)
+                std::memcpy(dest, channels[ch] + size1, sizeof(float) * (size_t)(toWrite - size1));
+        }
+
+        writeCount.store(w + static_cast<uint32_t>(toWrite), std::memory_order_release);
+    }
+
+    // Consumer. Exposes the oldest numSamples without consuming them. Returns
+    // false (and an empty region) if fewer than numSamples are ready.
+    bool peek(int numSamples, Region& region) const noexcept
+    {
+        region = {};
+
+        if (numSamples <= 0 || getNumReady() < numSamples)
+            return false;
+
+        region.start = static_cast<int>(readCount.load(std::memory_order_relaxed) & mask);
+        region.size1 = juce::jmin(numSamples, getCapacity() - region.start);
+        region.size2 = numSamples - region.size1;
+        return true;
+    }
+
+    // One channel of a peeked region as up to two contiguous spans
+    void getSpans(const Region& region, int channel, Span& first, Span& second) const noexcept
+    {
+        const auto* src = buffer.getReadPointer(channel);
+        first = { src + region.start, region.size1 };
+        second = { src, region.size2 };
+    }
+
+    // Consumes numSamples in every channel (clamped to what is ready)
+    void discard(int numSamples) noexcept
+    {
+        const int toDiscard = juce::jmin(numSamples, getNumReady());
+        if (toDiscard > 0)
+            readCount.fetch_add(static_cast<uint32_t>(toDiscard), std::memory_order_release);
+    }
+
+    // Samples (per channel) the producer had to drop because the ring was
+    // full, and how many pushes that happened on. Safe to read from any thread.
+    uint64_t getNumOverflowedSamples() const noexcept { return overflowedSamples.load(std::memory_order_relaxed); }
+    uint64_t getNumOverflows() const noexcept { return overflowEvents.load(std::memory_order_relaxed); }
+
+private:
+    juce::AudioBuffer<float> buffer;
+    uint32_t mask = 0;
+
+    // Free-running counters; the difference is the number of samples ready.
+    alignas(64) std::atomic<uint32_t> writeCount{0};
+    alignas(64) std::atomic<uint32_t> readCount{0};
+
+    alignas(64) std::atomic<uint64_t> overflowedSamples{0};
+    std::atomic<uint64_t> overflowEvents{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureRing)
+};
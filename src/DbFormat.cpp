@@ -0,0 +1,153 @@
+#include "DbFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr float range = DbFormat::maxDb - DbFormat::minDb;
+
+    template <typename Code>
+    void encodeNormalised(const float* db, Code* dest, int num) noexcept
+    {
+        constexpr float maxCode = static_cast<float>(static_cast<Code>(~Code(0)));
+        constexpr float codesPerDb = maxCode / range;
+
+        for (int i = 0; i < num; ++i)
+        {
+            const float code = std::clamp((db[i] - DbFormat::minDb) * codesPerDb, 0.0f, maxCode);
+            dest[i] = static_cast<Code>(code + 0.5f);
+        }
+    }
+
+    // Exactly what the GPU does with a normalised texel and the shader's
+    // multiply-add
+    template <typename Code>
+    void decodeNormalised(const Code* src, float* db, int num) noexcept
+    {
+        constexpr float maxCode = static_cast<float>(static_cast<Code>(~Code(0)));
+
+        for (int i = 0; i < num; ++i)
+            db[i] = (static_cast<float>(src[i]) / maxCode) * range + DbFormat::minDb;
+    }
+}
+
+int DbFormat::getBytesPerValue(Type type) noexcept
+{
+    switch (type)
+    {
+        case Type::float32: return 4;
+        case Type::float16: return 2;
+        case Type::unorm16: return 2;
+        case Type::unorm8:  return 1;
+    }
+
+    return 4;
+}
+
+void DbFormat::encode(Type type, const float* db, void* dest, int num) noexcept
+{
+    switch (type)
+    {
+        case Type::float32:
+            std::memcpy(dest, db, static_cast<size_t>(num) * sizeof(float));
+            break;
+
+        case Type::float16:
+        {
+            auto* half = static_cast<uint16_t*>(dest);
+
+            for (int i = 0; i < num; ++i)
+                half[i] = floatToHalf(db[i]);
+
+            break;
+        }
+
+        case Type::unorm16: encodeNormalised(db, static_cast<uint16_t*>(dest), num); break;
+        case Type::unorm8:  encodeNormalised(db, static_cast<uint8_t*>(dest), num); break;
+    }
+}
+
+void DbFormat::decode(Type type, const void* src, float* db, int num) noexcept
+{
+    switch (type)
+    {
+        case Type::float32:
+            std::memcpy(db, src, static_cast<size_t>(num) * sizeof(float));
+            break;
+
+        case Type::float16:
+        {
+            const auto* half = static_cast<const uint16_t*>(src);
+
+            for (int i = 0; i < num; ++i)
+                db[i] = halfToFloat(half[i]);
+
+            break;
+        }
+
+        case Type::unorm16: decodeNormalised(static_cast<const uint16_t*>(src), db, num); break;
+        case Type::unorm8:  decodeNormalised(static_cast<const uint8_t*>(src), db, num); break;
+    }
+}
+
+float DbFormat::getShaderScale(Type type) noexcept
+{
+    return type == Type::unorm16 || type == Type::unorm8 ? range : 1.0f;
+}
+
+float DbFormat::getShaderOffset(Type type) noexcept
+{
+    return type == Type::unorm16 || type == Type::unorm8 ? minDb : 0.0f;
+}
+
+uint16_t DbFormat::floatToHalf(float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t magnitude = bits & 0x7fffffffu;
+
+    // NaN stays NaN; infinity, and anything that rounds beyond 65504
+    if (magnitude > 0x7f800000u)
+        return static_cast<uint16_t>(sign | 0x7e00u);
+
+    if (magnitude >= 0x477ff000u)
+        return static_cast<uint16_t>(sign | 0x7c00u);
+
+    // Below 2^-14 the half is subnormal, in steps of 2^-24
+    if (magnitude < 0x38800000u)
+    {
+        const float steps = std::nearbyint(std::fabs(value) * 16777216.0f);
+        return static_cast<uint16_t>(sign | static_cast<uint16_t>(steps));
+    }
+
+    // Rebias the exponent and round the 13 bits dropped from the mantissa
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    const uint32_t dropped = magnitude & 0x1fffu;
+
+    if (dropped > 0x1000u || (dropped == 0x1000u && (half & 1u) != 0))
+        ++half;
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+float DbFormat::halfToFloat(uint16_t half) noexcept
+{
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1fu;
+    const uint32_t mantissa = half & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -magnitude : magnitude;
+    }
+
+    const uint32_t bits = exponent == 0x1fu ? sign | 0x7f800000u | (mantissa << 13)
+                                            : sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
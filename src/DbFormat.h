@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// How the spectrogram history and texture store dB values.
+//
+// They're only ever shown through a colour lookup between the floor and
+// ceiling, so 32-bit floats are more than the eye can use. Half floats step
+// by 0.06 dB around -100 dB; the unsigned-normalised formats spread a fixed
+// minDb .. maxDb range over their codes, 0.0025 dB a step at 16 bits and
+// 0.63 dB at 8. The GPU reads a normalised texel as 0..1, so the shader
+// gets dB back with one multiply-add.
+namespace DbFormat
+{
+    enum class Type
+    {
+        float32,
+        float16,
+        unorm16,
+        unorm8
+    };
+
+    // The range the normalised formats cover; values outside it are clamped
+    constexpr float minDb = -140.0f;
+    constexpr float maxDb = 20.0f;
+
+    int getBytesPerValue(Type type) noexcept;
+
+    void encode(Type type, const float* db, void* dest, int num) noexcept;
+    void decode(Type type, const void* src, float* db, int num) noexcept;
+
+    // A texel as the shader samples it, times scale plus offset, is in dB
+    float getShaderScale(Type type) noexcept;
+    float getShaderOffset(Type type) noexcept;
+
+    // IEEE half precision, rounding to nearest even
+    uint16_t floatToHalf(float value) noexcept;
+    float halfToFloat(uint16_t half) noexcept;
+}
@@ -0,0 +1,112 @@
+#include "DspKernels.h"
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+namespace
+{
+    const DspKernels::Table* getCompiledTable(DspKernels::Isa isa) noexcept
+    {
+        using namespace DspKernels;
+
+        switch (isa)
+        {
+            case Isa::scalar: return detail::getScalarTable();
+            case Isa::sse2:   return detail::getSSE2Table();
+            case Isa::avx2:   return detail::getAVX2Table();
+            case Isa::avx512: return detail::getAVX512Table();
+            case Isa::neon:   return detail::getNEONTable();
+        }
+        return nullptr;
+    }
+
+    bool cpuSupports(DspKernels::Isa isa) noexcept
+    {
+        using DspKernels::Isa;
+
+        switch (isa)
+        {
+            case Isa::scalar: return true;
+            case Isa::sse2:   return juce::SystemStats::hasSSE2();
+            case Isa::avx2:   return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+            case Isa::avx512: return juce::SystemStats::hasAVX512F();
+            case Isa::neon:   return juce::SystemStats::hasNeon();
+        }
+        return false;
+    }
+
+    const DspKernels::Table* detect() noexcept
+    {
+        using DspKernels::Isa;
+
+        const auto forced = juce::SystemStats::getEnvironmentVariable("SPECTROGRAM_FORCE_ISA", {})
+                                .trim().toLowerCase();
+
+        if (forced.isNotEmpty())
+        {
+            for (auto isa : { Isa::scalar, Isa::sse2, Isa::avx2, Isa::avx512, Isa::neon })
+                if (forced == DspKernels::getName(isa) && DspKernels::isSupported(isa))
+                    return getCompiledTable(isa);
+
+            DBG("SPECTROGRAM_FORCE_ISA=" + forced + " is not available, using detected ISA");
+        }
+
+        // Best first
+        for (auto isa : { Isa::avx512, Isa::avx2, Isa::sse2, Isa::neon })
+            if (DspKernels::isSupported(isa))
+                return getCompiledTable(isa);
+
+        return getCompiledTable(Isa::scalar);
+    }
+
+    std::atomic<const DspKernels::Table*>& activeTable() noexcept
+    {
+        static std::atomic<const DspKernels::Table*> table{ detect() };
+        return table;
+    }
+}
+
+const DspKernels::Table& DspKernels::get() noexcept
+{
+    return *activeTable().load(std::memory_order_acquire);
+}
+
+bool DspKernels::force(Isa isa) noexcept
+{
+    if (!isSupported(isa))
+        return false;
+
+    activeTable().store(getCompiledTable(isa), std::memory_order_release);
+    return true;
+}
+
+void DspKernels::resetToDetected() noexcept
+{
+    activeTable().store(detect(), std::memory_order_release);
+}
+
+bool DspKernels::isSupported(Isa isa) noexcept
+{
+    return getCompiledTable(isa) != nullptr && cpuSupports(isa);
+}
+
+const DspKernels::SizedTable* DspKernels::getSized(int fftSize) noexcept
+{
+    for (int i = 0; i < numSpecialisedFFTSizes; ++i)
+        if (specialisedFFTSizes[i] == fftSize)
+            return get().sized + i;
+
+    return nullptr;
+}
+
+const char* DspKernels::getName(Isa isa) noexcept
+{
+    switch (isa)
+    {
+        case Isa::scalar: return "scalar";
+        case Isa::sse2:   return "sse2";
+        case Isa::avx2:   return "avx2";
+        case Isa::avx512: return "avx512";
+        case Isa::neon:   return "neon";
+    }
+    return "scalar";
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <iterator>
+
+// Block-oriented DSP kernels shared by the processor, the analysers and the
+// editor. Every kernel exists once per instruction set; the best variant the
+// host CPU supports is picked once, on first use, and bound into a table of
+// function pointers. Call sites go through the inline wrappers below (or grab
+// the table once with DspKernels::get() in a hot loop).
+namespace DspKernels
+{
+    // Lowest level any kernel reports, in dB
+    static constexpr float floorDb = -100.0f;
+
+    enum class Isa { scalar, sse2, avx2, avx512, neon };
+
+    // FFT sizes that get their own copy of the per-frame kernels: the sizes
+    // the processor offers
+    inline constexpr int specialisedFFTSizes[] = { 1024, 1536, 2048, 3072, 4096, 5120, 6144, 8192 };
+    inline constexpr int numSpecialisedFFTSizes = static_cast<int>(std::size(specialisedFFTSizes));
+
+    // The per-frame analysis kernels with the FFT size fixed at compile time.
+    // Every loop has a constant trip count, so the compiler drops the
+    // remainder handling, unrolls, and can keep the bin count in an
+    // immediate. Same semantics as the Table kernels of the same name with
+    // num = fftSize (windowing) or fftSize / 2 + 1 (bins).
+    struct SizedTable
+    {
+        int fftSize;
+
+        void (*applyWindow)(float* dest, const float* src, const float* window) noexcept;
+        void (*mixAndWindow)(float* dest, const float* left, const float* right, const float* window) noexcept;
+        void (*applyWindowPair)(float* dest, const float* left, const float* right, const float* window) noexcept;
+        void (*complexToDb)(const float* interleaved, float* destDb, float offsetDb) noexcept;
+        void (*powerToDb)(const float* power, float* destDb, float offsetDb) noexcept;
+        void (*splitStereo)(const float* spectrum, float* midPower, float* sidePower,
+                            float* stereoPower, float* pan) noexcept;
+    };
+
+    struct Table
+    {
+        Isa isa;
+
+        // dest[i] = src[i] * window[i]
+        void (*applyWindow)(float* dest, const float* src, const float* window, int num) noexcept;
+
+        // Windows two channels into one interleaved buffer, e.g. to pack them
+        // as the real and imaginary parts of a complex FFT input:
+        // dest[2i] = left[i] * window[i], dest[2i + 1] = right[i] * window[i]
+        void (*applyWindowPair)(float* dest, const float* left, const float* right,
+                                const float* window, int num) noexcept;
+
+        // dest[i] = (left[i] + right[i]) * 0.5
+        void (*mixToMono)(float* dest, const float* left, const float* right, int num) noexcept;
+
+        // dest[i] = (left[i] + right[i]) * 0.5 * window[i], in one pass
+        void (*mixAndWindow)(float* dest, const float* left, const float* right,
+                             const float* window, int num) noexcept;
+
+        // Converts interleaved complex bins (re, im, re, im, ...) straight from
+        // squared magnitude to dB: 10 * log10(re^2 + im^2) + offsetDb, clamped to
+        // floorDb. Normalisation (e.g. dividing by the FFT size) is folded into
+        // offsetDb, so no sqrt or divide is needed per bin.
+        //
+        // log10 is evaluated with a fast log2 approximation (exponent extraction
+        // plus a degree-4 polynomial on the mantissa). The absolute error is below
+        // 0.0004 dB over the full float range, far below anything visible.
+        void (*complexToDb)(const float* interleaved, float* destDb, int numBins, float offsetDb) noexcept;
+
+        // Same conversion for values that are already squared magnitudes. Safe to
+        // run in place (power == destDb).
+        void (*powerToDb)(const float* power, float* destDb, int num, float offsetDb) noexcept;
+
+        // The inverse, without the offset or floor: 10^(dB / 10), from a
+        // fast exp2 (power of two from the integer part, degree-5 polynomial
+        // for the fraction) within 2e-5 dB. Safe to run in place.
+        void (*dbToPower)(const float* db, float* destPower, int num) noexcept;
+
+        // Peak hold: where frame exceeds peak it becomes the new peak, otherwise
+        // the peak falls by decay. The result never drops below floor.
+        void (*maxWithDecay)(float* peak, const float* frame, int num, float decay, float floor) noexcept;
+
+        // Splits the full complex spectrum (interleaved, fftSize bins) of a
+        // packed L + iR transform into per-bin powers of 2 (L + R) and 2 (L - R),
+        // the square of (|2L| + |2R|) / 2, and pan (|R| - |L|) / (|L| + |R|),
+        // which is 0 where both are negligible. Writes fftSize / 2 + 1 bins.
+        void (*splitStereo)(const float* spectrum, float* midPower, float* sidePower,
+                            float* stereoPower, float* pan, int fftSize) noexcept;
+
+        // Splits alternate samples: even[i] = src[2i], odd[i] = src[2i + 1]
+        void (*deinterleave)(float* even, float* odd, const float* src, int numPairs) noexcept;
+
+        // The arithmetic of a half-band FIR, whose centre tap is 0.5 and whose
+        // other even taps are zero:
+        // dest[i] = 0.5 centre[i] + sum over k of oddTaps[k] (taps[i + k] + taps[i - 1 - k]).
+        // taps must be readable from index -numOddTaps.
+        void (*halfBandFilter)(float* dest, const float* centre, const float* taps,
+                               const float* oddTaps, int numOddTaps, int num) noexcept;
+
+        // The sliding-DFT recurrence over a block of input: for each delta
+        // in turn, every bin becomes
+        // (re[i] + delta[s] + j im[i]) * (twiddleRe[i] + j twiddleIm[i]).
+        // Bins are independent, so each is carried through the whole block
+        // in registers.
+        void (*slidingDft)(float* re, float* im, const float* twiddleRe, const float* twiddleIm,
+                           int numBins, const float* delta, int numSamples) noexcept;
+
+        // One per entry of specialisedFFTSizes, in the same order
+        const SizedTable* sized;
+    };
+
+    // The active table. Detection runs once; the SPECTROGRAM_FORCE_ISA
+    // environment variable (scalar, sse2, avx2, avx512, neon) overrides it.
+    const Table& get() noexcept;
+
+    // Forces a specific implementation, e.g. to compare variants in a test.
+    // Returns false (and leaves the active table alone) if the ISA was not
+    // compiled in or the CPU doesn't support it.
+    bool force(Isa isa) noexcept;
+
+    // Re-runs detection, undoing any force() call.
+    void resetToDetected() noexcept;
+
+    bool isSupported(Isa isa) noexcept;
+    const char* getName(Isa isa) noexcept;
+
+    // The active ISA's kernels specialised for fftSize, or nullptr if that
+    // size isn't one of specialisedFFTSizes
+    const SizedTable* getSized(int fftSize) noexcept;
+
+    inline void applyWindow(float* dest, const float* src, const float* window, int num) noexcept
+    {
+        get().applyWindow(dest, src, window, num);
+    }
+
+    inline void applyWindowPair(float* dest, const float* left, const float* right,
+                                const float* window, int num) noexcept
+    {
+        get().applyWindowPair(dest, left, right, window, num);
+    }
+
+    inline void mixToMono(float* dest, const float* left, const float* right, int num) noexcept
+    {
+        get().mixToMono(dest, left, right, num);
+    }
+
+    inline void mixAndWindow(float* dest, const float* left, const float* right,
+                             const float* window, int num) noexcept
+    {
+        get().mixAndWindow(dest, left, right, window, num);
+    }
+
+    inline void complexToDb(const float* interleaved, float* destDb, int numBins, float offsetDb) noexcept
+    {
+        get().complexToDb(interleaved, destDb, numBins, offsetDb);
+    }
+
+    inline void powerToDb(const float* power, float* destDb, int num, float offsetDb) noexcept
+    {
+        get().powerToDb(power, destDb, num, offsetDb);
+    }
+
+    inline void dbToPower(const float* db, float* destPower, int num) noexcept
+    {
+        get().dbToPower(db, destPower, num);
+    }
+
+    inline void maxWithDecay(float* peak, const float* frame, int num, float decay, float floor) noexcept
+    {
+        get().maxWithDecay(peak, frame, num, decay, floor);
+    }
+
+    inline void deinterleave(float* even, float* odd, const float* src, int numPairs) noexcept
+    {
+        get().deinterleave(even, odd, src, numPairs);
+    }
+
+    inline void halfBandFilter(float* dest, const float* centre, const float* taps,
+                               const float* oddTaps, int numOddTaps, int num) noexcept
+    {
+        get().halfBandFilter(dest, centre, taps, oddTaps, numOddTaps, num);
+    }
+
+    inline void slidingDft(float* re, float* im, const float* twiddleRe, const float* twiddleIm,
+                           int numBins, const float* delta, int numSamples) noexcept
+    {
+        get().slidingDft(re, im, twiddleRe, twiddleIm, numBins, delta, numSamples);
+    }
+
+    namespace detail
+    {
+        // One per ISA translation unit; nullptr when that ISA isn't compiled in
+        const Table* getScalarTable() noexcept;
+        const Table* getSSE2Table() noexcept;
+        const Table* getAVX2Table() noexcept;
+        const Table* getAVX512Table() noexcept;
+        const Table* getNEONTable() noexcept;
+    }
+}
@@ -0,0 +1,127 @@
+#include "DspKernelsImpl.h"
+
+// Built with AVX2 + FMA code generation (see CMakeLists.txt); only ever
+// called after runtime detection has confirmed the CPU supports both.
+#if defined(__AVX2__)
+ #include <immintrin.h>
+
+namespace
+{
+    using namespace DspKernels::detail;
+
+    struct AVX2Ops
+    {
+        using V = __m256;
+        static constexpr int width = 8;
+
+        static V load(const float* p) noexcept          { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v) noexcept       { _mm256_storeu_ps(p, v); }
+        static V set(float v) noexcept                  { return _mm256_set1_ps(v); }
+        static V add(V a, V b) noexcept                 { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) noexcept                 { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) noexcept                 { return _mm256_mul_ps(a, b); }
+        static V div(V a, V b) noexcept                 { return _mm256_div_ps(a, b); }
+        static V max(V a, V b) noexcept                 { return _mm256_max_ps(a, b); }
+        static V sqrt(V x) noexcept                     { return _mm256_sqrt_ps(x); }
+
+        static V selectGreater(V a, V b, V c) noexcept
+        {
+            return _mm256_blendv_ps(c, a, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+        }
+
+        static V blendGreater(V a, V b, V x, V y) noexcept
+        {
+            return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+        }
+
+        static V log2(V x) noexcept
+        {
+            const __m256i bits = _mm256_castps_si256(x);
+            const V exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+                                                                   _mm256_set1_epi32(127)));
+            const V mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                                   _mm256_set1_epi32(0x3f800000)));
+            const V t = _mm256_sub_ps(mantissa, _mm256_set1_ps(1.0f));
+
+            V poly = _mm256_fmadd_ps(t, _mm256_set1_ps(log2C4), _mm256_set1_ps(log2C3));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(log2C2));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(log2C1));
+            return _mm256_fmadd_ps(t, poly, exponent);
+        }
+
+        static V exp2(V x) noexcept
+        {
+            x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-exp2Limit)), _mm256_set1_ps(exp2Limit));
+
+            // x + 128 is positive, so truncating it floors it
+            const __m256i n = _mm256_sub_epi32(_mm256_cvttps_epi32(_mm256_add_ps(x, _mm256_set1_ps(128.0f))),
+                                               _mm256_set1_epi32(128));
+            const V t = _mm256_sub_ps(x, _mm256_cvtepi32_ps(n));
+            const V scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+
+            V poly = _mm256_fmadd_ps(t, _mm256_set1_ps(exp2C5), _mm256_set1_ps(exp2C4));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(exp2C3));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(exp2C2));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(exp2C1));
+            poly = _mm256_fmadd_ps(t, poly, _mm256_set1_ps(1.0f));
+            return _mm256_mul_ps(poly, scale);
+        }
+
+        static V complexPower(const float* z) noexcept
+        {
+            const V a = _mm256_loadu_ps(z);         // r0 i0 r1 i1 | r2 i2 r3 i3
+            const V b = _mm256_loadu_ps(z + 8);     // r4 i4 r5 i5 | r6 i6 r7 i7
+            const V aa = _mm256_mul_ps(a, a);
+            const V bb = _mm256_mul_ps(b, b);
+
+            // Per 128-bit lane this yields r0 r1 r4 r5 | r2 r3 r6 r7; the 64-bit
+            // permute puts the bins back in order.
+            const V sum = _mm256_add_ps(_mm256_shuffle_ps(aa, bb, _MM_SHUFFLE(2, 0, 2, 0)),
+                                        _mm256_shuffle_ps(aa, bb, _MM_SHUFFLE(3, 1, 3, 1)));
+            return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        static void loadComplex(const float* z, V& re, V& im) noexcept
+        {
+            const V a = _mm256_loadu_ps(z);
+            const V b = _mm256_loadu_ps(z + 8);
+
+            // Same lane fix-up as complexPower
+            const V reLanes = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const V imLanes = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(reLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+            im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(imLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        static void loadComplexReversed(const float* z, V& re, V& im) noexcept
+        {
+            loadComplex(z, re, im);
+            const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+            re = _mm256_permutevar8x32_ps(re, reverse);
+            im = _mm256_permutevar8x32_ps(im, reverse);
+        }
+
+
+        static void storeInterleaved(float* dest, V a, V b) noexcept
+        {
+            // unpack works per 128-bit lane: lo = a0 b0 a1 b1 | a4 b4 a5 b5,
+            // hi = a2 b2 a3 b3 | a6 b6 a7 b7
+            const V lo = _mm256_unpacklo_ps(a, b);
+            const V hi = _mm256_unpackhi_ps(a, b);
+            _mm256_storeu_ps(dest,     _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(dest + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+    };
+}
+
+const DspKernels::Table* DspKernels::detail::getAVX2Table() noexcept
+{
+    static const Table table = makeTable<AVX2Ops>(Isa::avx2);
+    return &table;
+}
+
+#else
+
+const DspKernels::Table* DspKernels::detail::getAVX2Table() noexcept { return nullptr; }
+
+#endif
@@ -0,0 +1,122 @@
+#include "DspKernelsImpl.h"
+
+// Built with AVX-512F code generation (see CMakeLists.txt); only ever called
+// after runtime detection has confirmed the CPU supports it.
+#if defined(__AVX512F__)
+ #include <immintrin.h>
+
+namespace
+{
+    using namespace DspKernels::detail;
+
+    struct AVX512Ops
+    {
+        using V = __m512;
+        static constexpr int width = 16;
+
+        static V load(const float* p) noexcept          { return _mm512_loadu_ps(p); }
+        static void store(float* p, V v) noexcept       { _mm512_storeu_ps(p, v); }
+        static V set(float v) noexcept                  { return _mm512_set1_ps(v); }
+        static V add(V a, V b) noexcept                 { return _mm512_add_ps(a, b); }
+        static V sub(V a, V b) noexcept                 { return _mm512_sub_ps(a, b); }
+        static V mul(V a, V b) noexcept                 { return _mm512_mul_ps(a, b); }
+        static V div(V a, V b) noexcept                 { return _mm512_div_ps(a, b); }
+        static V max(V a, V b) noexcept                 { return _mm512_max_ps(a, b); }
+        static V sqrt(V x) noexcept                     { return _mm512_sqrt_ps(x); }
+
+        static V selectGreater(V a, V b, V c) noexcept
+        {
+            return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), c, a);
+        }
+
+        static V blendGreater(V a, V b, V x, V y) noexcept
+        {
+            return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+        }
+
+        static V log2(V x) noexcept
+        {
+            const __m512i bits = _mm512_castps_si512(x);
+            const V exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23),
+                                                                   _mm512_set1_epi32(127)));
+            const V mantissa = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+                                                                   _mm512_set1_epi32(0x3f800000)));
+            const V t = _mm512_sub_ps(mantissa, _mm512_set1_ps(1.0f));
+
+            V poly = _mm512_fmadd_ps(t, _mm512_set1_ps(log2C4), _mm512_set1_ps(log2C3));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(log2C2));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(log2C1));
+            return _mm512_fmadd_ps(t, poly, exponent);
+        }
+
+        static V exp2(V x) noexcept
+        {
+            x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-exp2Limit)), _mm512_set1_ps(exp2Limit));
+
+            // x + 128 is positive, so truncating it floors it
+            const __m512i n = _mm512_sub_epi32(_mm512_cvttps_epi32(_mm512_add_ps(x, _mm512_set1_ps(128.0f))),
+                                               _mm512_set1_epi32(128));
+            const V t = _mm512_sub_ps(x, _mm512_cvtepi32_ps(n));
+            const V scale = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(n, _mm512_set1_epi32(127)), 23));
+
+            V poly = _mm512_fmadd_ps(t, _mm512_set1_ps(exp2C5), _mm512_set1_ps(exp2C4));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(exp2C3));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(exp2C2));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(exp2C1));
+            poly = _mm512_fmadd_ps(t, poly, _mm512_set1_ps(1.0f));
+            return _mm512_mul_ps(poly, scale);
+        }
+
+        static V complexPower(const float* z) noexcept
+        {
+            const V a = _mm512_loadu_ps(z);
+            const V b = _mm512_loadu_ps(z + 16);
+            const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            const __m512i odds  = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+            const V re = _mm512_permutex2var_ps(a, evens, b);
+            const V im = _mm512_permutex2var_ps(a, odds, b);
+            return _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im));
+        }
+
+        static void loadComplex(const float* z, V& re, V& im) noexcept
+        {
+            const V a = _mm512_loadu_ps(z);
+            const V b = _mm512_loadu_ps(z + 16);
+            const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            const __m512i odds  = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+            re = _mm512_permutex2var_ps(a, evens, b);
+            im = _mm512_permutex2var_ps(a, odds, b);
+        }
+
+        static void loadComplexReversed(const float* z, V& re, V& im) noexcept
+        {
+            const V a = _mm512_loadu_ps(z);
+            const V b = _mm512_loadu_ps(z + 16);
+            const __m512i evens = _mm512_setr_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+            const __m512i odds  = _mm512_setr_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+            re = _mm512_permutex2var_ps(a, evens, b);
+            im = _mm512_permutex2var_ps(a, odds, b);
+        }
+
+
+        static void storeInterleaved(float* dest, V a, V b) noexcept
+        {
+            const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+            const __m512i hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+            _mm512_storeu_ps(dest,      _mm512_permutex2var_ps(a, lo, b));
+            _mm512_storeu_ps(dest + 16, _mm512_permutex2var_ps(a, hi, b));
+        }
+    };
+}
+
+const DspKernels::Table* DspKernels::detail::getAVX512Table() noexcept
+{
+    static const Table table = makeTable<AVX512Ops>(Isa::avx512);
+    return &table;
+}
+
+#else
+
+const DspKernels::Table* DspKernels::detail::getAVX512Table() noexcept { return nullptr; }
+
+#endif
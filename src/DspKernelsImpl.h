@@ -0,0 +1,523 @@
+#pragma once
+
+// Generic kernel bodies, instantiated once per ISA translation unit with an
+// Ops struct that wraps that ISA's vector type. Only include this from the
+// DspKernels<ISA>.cpp files, which are compiled with the matching flags.
+//
+// An Ops struct provides:
+//   using V; static constexpr int width;
+//   load, store, set, add, sub, mul, div, max, sqrt, log2, exp2,
+//   complexPower (reads 2 * width interleaved floats, returns re^2 + im^2),
+//   loadComplex (deinterleaves width complex values into re and im),
+//   loadComplexReversed (the same, with the lanes in reverse order),
+//   selectGreater (a > b ? a : c), blendGreater (a > b ? x : y),
+//   storeInterleaved (writes a0 b0 a1 b1 ... over 2 * width floats)
+
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <math.h>
+#include <utility>
+
+namespace DspKernels::detail
+{
+    // 10 * log10(x) == dbPerOctave * log2(x)
+    constexpr float dbPerOctave = 3.0102999566f;
+
+    // Minimax fit of log2(1 + t) on t in [0, 1), exact at both ends so the
+    // approximation stays continuous across octaves. Max error 1.2e-4 (log2).
+    constexpr float log2C1 =  1.43872573f;
+    constexpr float log2C2 = -0.677783926f;
+    constexpr float log2C3 =  0.321188857f;
+    constexpr float log2C4 = -0.0821306608f;
+
+    // 10^(x / 10) == 2^(x * octavesPerDb)
+    constexpr float octavesPerDb = 0.332192809f;
+
+    // Least-squares fit of 2^t on t in [0, 1), exact at 0. Max relative
+    // error 1.9e-7. Inputs are clamped to +-exp2Limit so 2^floor(x) stays a
+    // normal float.
+    constexpr float exp2C1 = 0.693151591f;
+    constexpr float exp2C2 = 0.240164346f;
+    constexpr float exp2C3 = 0.0557938212f;
+    constexpr float exp2C4 = 0.00903105311f;
+    constexpr float exp2C5 = 0.00185880868f;
+    constexpr float exp2Limit = 126.0f;
+
+    // Not inline functions with external linkage: every ISA's translation
+    // unit compiles these with its own flags, and the linker could keep an
+    // AVX-built copy for the scalar and SSE2 paths too. For the same reason
+    // the scalar code avoids std::max and std::sqrt, whose out-of-line
+    // copies (in unoptimised builds) would be shared the same way.
+    namespace
+    {
+        inline float maxScalar(float a, float b) noexcept { return a < b ? b : a; }
+        inline float sqrtScalar(float x) noexcept         { return ::sqrtf(x); }
+
+        inline float fastLog2(float x) noexcept
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+
+            const auto exponent = static_cast<float>(static_cast<int>((bits >> 23) & 0xffu) - 127);
+            bits = (bits & 0x007fffffu) | 0x3f800000u;
+
+            float mantissa;
+            std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+            const float t = mantissa - 1.0f;
+            return exponent + t * (log2C1 + t * (log2C2 + t * (log2C3 + t * log2C4)));
+        }
+
+        inline float powerToDbScalar(float power, float offsetDb) noexcept
+        {
+            return maxScalar(dbPerOctave * fastLog2(power) + offsetDb, floorDb);
+        }
+
+        inline float fastExp2(float x) noexcept
+        {
+            x = x < -exp2Limit ? -exp2Limit : (x > exp2Limit ? exp2Limit : x);
+
+            // x + 128 is positive, so truncating it floors it
+            const int n = static_cast<int>(x + 128.0f) - 128;
+            const float t = x - static_cast<float>(n);
+
+            const auto bits = static_cast<uint32_t>(n + 127) << 23;
+            float scale;
+            std::memcpy(&scale, &bits, sizeof(scale));
+
+            return scale * (1.0f + t * (exp2C1 + t * (exp2C2 + t * (exp2C3 + t * (exp2C4 + t * exp2C5)))));
+        }
+
+        // Scalar Ops: also used for the tails of every vector kernel
+        struct ScalarOps
+        {
+            using V = float;
+            static constexpr int width = 1;
+
+            static V load(const float* p) noexcept          { return *p; }
+            static void store(float* p, V v) noexcept       { *p = v; }
+            static V set(float v) noexcept                  { return v; }
+            static V add(V a, V b) noexcept                 { return a + b; }
+            static V sub(V a, V b) noexcept                 { return a - b; }
+            static V mul(V a, V b) noexcept                 { return a * b; }
+            static V div(V a, V b) noexcept                 { return a / b; }
+            static V max(V a, V b) noexcept                 { return maxScalar(a, b); }
+            static V sqrt(V x) noexcept                     { return sqrtScalar(x); }
+            static V log2(V x) noexcept                     { return fastLog2(x); }
+            static V exp2(V x) noexcept                     { return fastExp2(x); }
+            static V selectGreater(V a, V b, V c) noexcept  { return a > b ? a : c; }
+            static V blendGreater(V a, V b, V x, V y) noexcept { return a > b ? x : y; }
+
+            static void loadComplex(const float* z, V& re, V& im) noexcept
+            {
+                re = z[0];
+                im = z[1];
+            }
+
+            static void loadComplexReversed(const float* z, V& re, V& im) noexcept
+            {
+                loadComplex(z, re, im);
+            }
+
+            static V complexPower(const float* z) noexcept
+            {
+                return z[0] * z[0] + z[1] * z[1];
+            }
+
+
+            static void storeInterleaved(float* dest, V a, V b) noexcept
+            {
+                dest[0] = a;
+                dest[1] = b;
+            }
+        };
+    }
+
+    template <typename Ops>
+    inline typename Ops::V powerToDbVec(typename Ops::V power, typename Ops::V offset) noexcept
+    {
+        const auto db = Ops::add(Ops::mul(Ops::log2(power), Ops::set(dbPerOctave)), offset);
+        return Ops::max(db, Ops::set(floorDb));
+    }
+
+    template <typename Ops>
+    void applyWindow(float* dest, const float* src, const float* window, int num) noexcept
+    {
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+            Ops::store(dest + i, Ops::mul(Ops::load(src + i), Ops::load(window + i)));
+
+        for (; i < num; ++i)
+            dest[i] = src[i] * window[i];
+    }
+
+    template <typename Ops>
+    void applyWindowPair(float* dest, const float* left, const float* right,
+                         const float* window, int num) noexcept
+    {
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+        {
+            const auto w = Ops::load(window + i);
+            Ops::storeInterleaved(dest + i * 2, Ops::mul(Ops::load(left + i), w),
+                                                Ops::mul(Ops::load(right + i), w));
+        }
+
+        for (auto* d = dest + i * 2; i < num; ++i, d += 2)
+        {
+            d[0] = left[i] * window[i];
+            d[1] = right[i] * window[i];
+        }
+    }
+
+    template <typename Ops>
+    void mixToMono(float* dest, const float* left, const float* right, int num) noexcept
+    {
+        const auto half = Ops::set(0.5f);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+            Ops::store(dest + i, Ops::mul(Ops::add(Ops::load(left + i), Ops::load(right + i)), half));
+
+        for (; i < num; ++i)
+            dest[i] = (left[i] + right[i]) * 0.5f;
+    }
+
+    template <typename Ops>
+    void mixAndWindow(float* dest, const float* left, const float* right,
+                      const float* window, int num) noexcept
+    {
+        const auto half = Ops::set(0.5f);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+        {
+            const auto mix = Ops::mul(Ops::add(Ops::load(left + i), Ops::load(right + i)), half);
+            Ops::store(dest + i, Ops::mul(mix, Ops::load(window + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] = (left[i] + right[i]) * 0.5f * window[i];
+    }
+
+    template <typename Ops>
+    void complexToDb(const float* interleaved, float* destDb, int numBins, float offsetDb) noexcept
+    {
+        const auto offset = Ops::set(offsetDb);
+
+        int bin = 0;
+        for (; bin + Ops::width <= numBins; bin += Ops::width)
+            Ops::store(destDb + bin, powerToDbVec<Ops>(Ops::complexPower(interleaved + bin * 2), offset));
+
+        for (; bin < numBins; ++bin)
+            destDb[bin] = powerToDbScalar(ScalarOps::complexPower(interleaved + bin * 2), offsetDb);
+    }
+
+    template <typename Ops>
+    void powerToDb(const float* power, float* destDb, int num, float offsetDb) noexcept
+    {
+        const auto offset = Ops::set(offsetDb);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+            Ops::store(destDb + i, powerToDbVec<Ops>(Ops::load(power + i), offset));
+
+        for (; i < num; ++i)
+            destDb[i] = powerToDbScalar(power[i], offsetDb);
+    }
+
+    template <typename Ops>
+    void dbToPower(const float* db, float* destPower, int num) noexcept
+    {
+        const auto scale = Ops::set(octavesPerDb);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+            Ops::store(destPower + i, Ops::exp2(Ops::mul(Ops::load(db + i), scale)));
+
+        for (; i < num; ++i)
+            destPower[i] = fastExp2(db[i] * octavesPerDb);
+    }
+
+    template <typename Ops>
+    void maxWithDecay(float* peak, const float* frame, int num, float decay, float floor) noexcept
+    {
+        const auto decayV = Ops::set(decay);
+        const auto floorV = Ops::set(floor);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+        {
+            const auto p = Ops::load(peak + i);
+            const auto f = Ops::load(frame + i);
+            Ops::store(peak + i, Ops::max(Ops::selectGreater(f, p, Ops::sub(p, decayV)), floorV));
+        }
+
+        for (; i < num; ++i)
+            peak[i] = maxScalar(frame[i] > peak[i] ? frame[i] : peak[i] - decay, floor);
+    }
+
+    // One bin of splitStereo, for DC and the tail. Templated on Ops only so
+    // that each ISA's translation unit keeps its own copy.
+    template <typename Ops>
+    inline void splitStereoBin(const float* z, int bin, int mirror, float pan0Threshold,
+                               float* midPower, float* sidePower, float* stereoPower, float* pan) noexcept
+    {
+        // Z = FFT(L + iR):  2 L[k] = Z[k] + conj(Z[N - k]),  2 R[k] = -i (Z[k] - conj(Z[N - k]))
+        const float zr = z[bin * 2],    zi = z[bin * 2 + 1];
+        const float cr = z[mirror * 2], ci = -z[mirror * 2 + 1];
+
+        const float lr = zr + cr, li = zi + ci;
+        const float rr = zi - ci, ri = cr - zr;
+
+        const float midR = lr + rr, midI = li + ri;
+        const float sideR = lr - rr, sideI = li - ri;
+        midPower[bin] = midR * midR + midI * midI;
+        sidePower[bin] = sideR * sideR + sideI * sideI;
+
+        const float magL = sqrtScalar(lr * lr + li * li);
+        const float magR = sqrtScalar(rr * rr + ri * ri);
+        const float total = magL + magR;
+        const float combined = total * 0.5f;
+
+        stereoPower[bin] = combined * combined;
+        pan[bin] = total > pan0Threshold ? (magR - magL) / total : 0.0f;
+    }
+
+    template <typename Ops>
+    void splitStereo(const float* spectrum, float* midPower, float* sidePower,
+                     float* stereoPower, float* pan, int fftSize) noexcept
+    {
+        const float threshold = 1e-10f * static_cast<float>(fftSize);
+
+        // DC pairs with itself
+        splitStereoBin<Ops>(spectrum, 0, 0, threshold, midPower, sidePower, stereoPower, pan);
+
+        const auto thresholdV = Ops::set(threshold);
+        const auto half = Ops::set(0.5f);
+        const auto zero = Ops::set(0.0f);
+        const int lastBin = fftSize / 2;
+
+        // Bins [bin, bin + width) pair with [N - bin - width + 1, N - bin] read
+        // backwards, so both sides load as whole vectors
+        int bin = 1;
+        for (; bin + Ops::width - 1 <= lastBin; bin += Ops::width)
+        {
+            typename Ops::V zr, zi, mr, mi;
+            Ops::loadComplex(spectrum + bin * 2, zr, zi);
+            Ops::loadComplexReversed(spectrum + (fftSize - bin - Ops::width + 1) * 2, mr, mi);
+
+            // 2 L = Z + conj(M),  2 R = -i (Z - conj(M))
+            const auto lr = Ops::add(zr, mr), li = Ops::sub(zi, mi);
+            const auto rr = Ops::add(zi, mi), ri = Ops::sub(mr, zr);
+
+            const auto midR = Ops::add(lr, rr), midI = Ops::add(li, ri);
+            const auto sideR = Ops::sub(lr, rr), sideI = Ops::sub(li, ri);
+            Ops::store(midPower + bin, Ops::add(Ops::mul(midR, midR), Ops::mul(midI, midI)));
+            Ops::store(sidePower + bin, Ops::add(Ops::mul(sideR, sideR), Ops::mul(sideI, sideI)));
+
+            const auto magL = Ops::sqrt(Ops::add(Ops::mul(lr, lr), Ops::mul(li, li)));
+            const auto magR = Ops::sqrt(Ops::add(Ops::mul(rr, rr), Ops::mul(ri, ri)));
+            const auto total = Ops::add(magL, magR);
+            const auto combined = Ops::mul(total, half);
+            Ops::store(stereoPower + bin, Ops::mul(combined, combined));
+
+            // Lanes below the threshold may divide by zero; they're replaced
+            Ops::store(pan + bin, Ops::blendGreater(total, thresholdV,
+                                                    Ops::div(Ops::sub(magR, magL), total), zero));
+        }
+
+        for (; bin <= lastBin; ++bin)
+            splitStereoBin<Ops>(spectrum, bin, fftSize - bin, threshold, midPower, sidePower, stereoPower, pan);
+    }
+
+    template <typename Ops>
+    void deinterleave(float* even, float* odd, const float* src, int numPairs) noexcept
+    {
+        int i = 0;
+        for (; i + Ops::width <= numPairs; i += Ops::width)
+        {
+            typename Ops::V e, o;
+            Ops::loadComplex(src + i * 2, e, o);
+            Ops::store(even + i, e);
+            Ops::store(odd + i, o);
+        }
+
+        for (; i < numPairs; ++i)
+        {
+            even[i] = src[i * 2];
+            odd[i] = src[i * 2 + 1];
+        }
+    }
+
+    template <typename Ops>
+    void halfBandFilter(float* dest, const float* centre, const float* taps,
+                        const float* oddTaps, int numOddTaps, int num) noexcept
+    {
+        const auto half = Ops::set(0.5f);
+
+        int i = 0;
+        for (; i + Ops::width <= num; i += Ops::width)
+        {
+            auto sum = Ops::mul(Ops::load(centre + i), half);
+
+            for (int k = 0; k < numOddTaps; ++k)
+            {
+                const auto pair = Ops::add(Ops::load(taps + i + k), Ops::load(taps + i - 1 - k));
+                sum = Ops::add(sum, Ops::mul(pair, Ops::set(oddTaps[k])));
+            }
+
+            Ops::store(dest + i, sum);
+        }
+
+        for (; i < num; ++i)
+        {
+            float sum = centre[i] * 0.5f;
+
+            for (int k = 0; k < numOddTaps; ++k)
+                sum += (taps[i + k] + taps[i - 1 - k]) * oddTaps[k];
+
+            dest[i] = sum;
+        }
+    }
+
+    // Slides slidingDftLanes vectors of bins through the block together.
+    // Each sample depends on the last, so a single vector would wait out
+    // the whole add-multiply latency per sample; independent ones fill it.
+    template <typename Ops, size_t lanes>
+    inline void slidingDftVectors(float* re, float* im, const float* twiddleRe, const float* twiddleIm,
+                                  const float* delta, int numSamples) noexcept
+    {
+        typename Ops::V r[lanes], m[lanes], tr[lanes], ti[lanes];
+
+        for (size_t l = 0; l < lanes; ++l)
+        {
+            const auto offset = static_cast<int>(l) * Ops::width;
+            r[l] = Ops::load(re + offset);
+            m[l] = Ops::load(im + offset);
+            tr[l] = Ops::load(twiddleRe + offset);
+            ti[l] = Ops::load(twiddleIm + offset);
+        }
+
+        for (int s = 0; s < numSamples; ++s)
+        {
+            const auto d = Ops::set(delta[s]);
+
+            for (size_t l = 0; l < lanes; ++l)
+            {
+                const auto shifted = Ops::add(r[l], d);
+                r[l] = Ops::sub(Ops::mul(shifted, tr[l]), Ops::mul(m[l], ti[l]));
+                m[l] = Ops::add(Ops::mul(shifted, ti[l]), Ops::mul(m[l], tr[l]));
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l)
+        {
+            const auto offset = static_cast<int>(l) * Ops::width;
+            Ops::store(re + offset, r[l]);
+            Ops::store(im + offset, m[l]);
+        }
+    }
+
+    constexpr size_t slidingDftLanes = 4;
+
+    template <typename Ops>
+    void slidingDft(float* re, float* im, const float* twiddleRe, const float* twiddleIm,
+                    int numBins, const float* delta, int numSamples) noexcept
+    {
+        constexpr int block = static_cast<int>(slidingDftLanes) * Ops::width;
+
+        int i = 0;
+        for (; i + block <= numBins; i += block)
+            slidingDftVectors<Ops, slidingDftLanes>(re + i, im + i, twiddleRe + i, twiddleIm + i, delta, numSamples);
+
+        for (; i + Ops::width <= numBins; i += Ops::width)
+            slidingDftVectors<Ops, 1>(re + i, im + i, twiddleRe + i, twiddleIm + i, delta, numSamples);
+
+        for (; i < numBins; ++i)
+        {
+            float r = re[i], m = im[i];
+
+            for (int s = 0; s < numSamples; ++s)
+            {
+                const float shifted = r + delta[s];
+                r = shifted * twiddleRe[i] - m * twiddleIm[i];
+                m = shifted * twiddleIm[i] + m * twiddleRe[i];
+            }
+
+            re[i] = r;
+            im[i] = m;
+        }
+    }
+
+    // Fixed-size wrappers: with N a constant, each call below is inlined
+    // with a constant trip count
+    template <typename Ops, int N>
+    struct Sized
+    {
+        static constexpr int numBins = N / 2 + 1;
+
+        static void applyWindow(float* dest, const float* src, const float* window) noexcept
+        {
+            detail::applyWindow<Ops>(dest, src, window, N);
+        }
+
+        static void mixAndWindow(float* dest, const float* left, const float* right, const float* window) noexcept
+        {
+            detail::mixAndWindow<Ops>(dest, left, right, window, N);
+        }
+
+        static void applyWindowPair(float* dest, const float* left, const float* right, const float* window) noexcept
+        {
+            detail::applyWindowPair<Ops>(dest, left, right, window, N);
+        }
+
+        static void complexToDb(const float* interleaved, float* destDb, float offsetDb) noexcept
+        {
+            detail::complexToDb<Ops>(interleaved, destDb, numBins, offsetDb);
+        }
+
+        static void powerToDb(const float* power, float* destDb, float offsetDb) noexcept
+        {
+            detail::powerToDb<Ops>(power, destDb, numBins, offsetDb);
+        }
+
+        static void splitStereo(const float* spectrum, float* midPower, float* sidePower,
+                                float* stereoPower, float* pan) noexcept
+        {
+            detail::splitStereo<Ops>(spectrum, midPower, sidePower, stereoPower, pan, N);
+        }
+
+        static constexpr SizedTable table { N, applyWindow, mixAndWindow, applyWindowPair,
+                                            complexToDb, powerToDb, splitStereo };
+    };
+
+    template <typename Ops, size_t... index>
+    const SizedTable* makeSizedTables(std::index_sequence<index...>) noexcept
+    {
+        static const SizedTable tables[] { Sized<Ops, specialisedFFTSizes[index]>::table... };
+        return tables;
+    }
+
+    template <typename Ops>
+    Table makeTable(Isa isa) noexcept
+    {
+        return { isa,
+                 applyWindow<Ops>,
+                 applyWindowPair<Ops>,
+                 mixToMono<Ops>,
+                 mixAndWindow<Ops>,
+                 complexToDb<Ops>,
+                 powerToDb<Ops>,
+                 dbToPower<Ops>,
+                 maxWithDecay<Ops>,
+                 splitStereo<Ops>,
+                 deinterleave<Ops>,
+                 halfBandFilter<Ops>,
+                 slidingDft<Ops>,
+                 makeSizedTables<Ops>(std::make_index_sequence<numSpecialisedFFTSizes>()) };
+    }
+}
@@ -0,0 +1,134 @@
+#include "DspKernelsImpl.h"
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+ #include <arm_neon.h>
+
+namespace
+{
+    using namespace DspKernels::detail;
+
+    struct NEONOps
+    {
+        using V = float32x4_t;
+        static constexpr int width = 4;
+
+        static V load(const float* p) noexcept          { return vld1q_f32(p); }
+        static void store(float* p, V v) noexcept       { vst1q_f32(p, v); }
+        static V set(float v) noexcept                  { return vdupq_n_f32(v); }
+        static V add(V a, V b) noexcept                 { return vaddq_f32(a, b); }
+        static V sub(V a, V b) noexcept                 { return vsubq_f32(a, b); }
+        static V mul(V a, V b) noexcept                 { return vmulq_f32(a, b); }
+        static V max(V a, V b) noexcept                 { return vmaxq_f32(a, b); }
+
+       #if defined(__aarch64__) || defined(_M_ARM64)
+        static V div(V a, V b) noexcept                 { return vdivq_f32(a, b); }
+        static V sqrt(V x) noexcept                     { return vsqrtq_f32(x); }
+       #else
+        // 32-bit NEON has neither; go lane by lane
+        static V div(V a, V b) noexcept
+        {
+            alignas(16) float x[width], y[width];
+            vst1q_f32(x, a);
+            vst1q_f32(y, b);
+            for (int i = 0; i < width; ++i)
+                x[i] /= y[i];
+            return vld1q_f32(x);
+        }
+
+        static V sqrt(V v) noexcept
+        {
+            alignas(16) float x[width];
+            vst1q_f32(x, v);
+            for (auto& lane : x)
+                lane = sqrtScalar(lane);
+            return vld1q_f32(x);
+        }
+       #endif
+
+        static V selectGreater(V a, V b, V c) noexcept
+        {
+            return vbslq_f32(vcgtq_f32(a, b), a, c);
+        }
+
+        static V blendGreater(V a, V b, V x, V y) noexcept
+        {
+            return vbslq_f32(vcgtq_f32(a, b), x, y);
+        }
+
+        static V log2(V x) noexcept
+        {
+            const uint32x4_t bits = vreinterpretq_u32_f32(x);
+            const V exponent = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)),
+                                                       vdupq_n_s32(127)));
+            const V mantissa = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffffu)),
+                                                               vdupq_n_u32(0x3f800000u)));
+            const V t = vsubq_f32(mantissa, vdupq_n_f32(1.0f));
+
+            V poly = vmlaq_f32(vdupq_n_f32(log2C3), t, vdupq_n_f32(log2C4));
+            poly = vmlaq_f32(vdupq_n_f32(log2C2), t, poly);
+            poly = vmlaq_f32(vdupq_n_f32(log2C1), t, poly);
+            return vmlaq_f32(exponent, t, poly);
+        }
+
+        static V exp2(V x) noexcept
+        {
+            x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-exp2Limit)), vdupq_n_f32(exp2Limit));
+
+            // x + 128 is positive, so truncating it floors it
+            const int32x4_t n = vsubq_s32(vcvtq_s32_f32(vaddq_f32(x, vdupq_n_f32(128.0f))), vdupq_n_s32(128));
+            const V t = vsubq_f32(x, vcvtq_f32_s32(n));
+            const V scale = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23));
+
+            V poly = vmlaq_f32(vdupq_n_f32(exp2C4), t, vdupq_n_f32(exp2C5));
+            poly = vmlaq_f32(vdupq_n_f32(exp2C3), t, poly);
+            poly = vmlaq_f32(vdupq_n_f32(exp2C2), t, poly);
+            poly = vmlaq_f32(vdupq_n_f32(exp2C1), t, poly);
+            poly = vmlaq_f32(vdupq_n_f32(1.0f), t, poly);
+            return vmulq_f32(poly, scale);
+        }
+
+        static V complexPower(const float* z) noexcept
+        {
+            const float32x4x2_t v = vld2q_f32(z);
+            return vmlaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+        }
+
+        static void loadComplex(const float* z, V& re, V& im) noexcept
+        {
+            const float32x4x2_t v = vld2q_f32(z);
+            re = v.val[0];
+            im = v.val[1];
+        }
+
+        static V reverse(V v) noexcept
+        {
+            const V pairsSwapped = vrev64q_f32(v);     // 1 0 3 2
+            return vcombine_f32(vget_high_f32(pairsSwapped), vget_low_f32(pairsSwapped));
+        }
+
+        static void loadComplexReversed(const float* z, V& re, V& im) noexcept
+        {
+            loadComplex(z, re, im);
+            re = reverse(re);
+            im = reverse(im);
+        }
+
+
+        static void storeInterleaved(float* dest, V a, V b) noexcept
+        {
+            vst2q_f32(dest, float32x4x2_t{ { a, b } });
+        }
+    };
+}
+
+const DspKernels::Table* DspKernels::detail::getNEONTable() noexcept
+{
+    static const Table table = makeTable<NEONOps>(Isa::neon);
+    return &table;
+}
+
+#else
+
+const DspKernels::Table* DspKernels::detail::getNEONTable() noexcept { return nullptr; }
+
+#endif
@@ -0,0 +1,112 @@
+#include "DspKernelsImpl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+
+namespace
+{
+    using namespace DspKernels::detail;
+
+    struct SSE2Ops
+    {
+        using V = __m128;
+        static constexpr int width = 4;
+
+        static V load(const float* p) noexcept          { return _mm_loadu_ps(p); }
+        static void store(float* p, V v) noexcept       { _mm_storeu_ps(p, v); }
+        static V set(float v) noexcept                  { return _mm_set1_ps(v); }
+        static V add(V a, V b) noexcept                 { return _mm_add_ps(a, b); }
+        static V sub(V a, V b) noexcept                 { return _mm_sub_ps(a, b); }
+        static V mul(V a, V b) noexcept                 { return _mm_mul_ps(a, b); }
+        static V div(V a, V b) noexcept                 { return _mm_div_ps(a, b); }
+        static V max(V a, V b) noexcept                 { return _mm_max_ps(a, b); }
+        static V sqrt(V x) noexcept                     { return _mm_sqrt_ps(x); }
+
+        static V selectGreater(V a, V b, V c) noexcept
+        {
+            const V mask = _mm_cmpgt_ps(a, b);
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, c));
+        }
+
+        static V blendGreater(V a, V b, V x, V y) noexcept
+        {
+            const V mask = _mm_cmpgt_ps(a, b);
+            return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+        }
+
+        static V log2(V x) noexcept
+        {
+            const __m128i bits = _mm_castps_si128(x);
+            const V exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+            const V mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                             _mm_set1_epi32(0x3f800000)));
+            const V t = _mm_sub_ps(mantissa, _mm_set1_ps(1.0f));
+
+            V poly = _mm_add_ps(_mm_set1_ps(log2C3), _mm_mul_ps(t, _mm_set1_ps(log2C4)));
+            poly = _mm_add_ps(_mm_set1_ps(log2C2), _mm_mul_ps(t, poly));
+            poly = _mm_add_ps(_mm_set1_ps(log2C1), _mm_mul_ps(t, poly));
+            return _mm_add_ps(exponent, _mm_mul_ps(t, poly));
+        }
+
+        static V exp2(V x) noexcept
+        {
+            x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-exp2Limit)), _mm_set1_ps(exp2Limit));
+
+            // x + 128 is positive, so truncating it floors it
+            const __m128i n = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(x, _mm_set1_ps(128.0f))), _mm_set1_epi32(128));
+            const V t = _mm_sub_ps(x, _mm_cvtepi32_ps(n));
+            const V scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+
+            V poly = _mm_add_ps(_mm_set1_ps(exp2C4), _mm_mul_ps(t, _mm_set1_ps(exp2C5)));
+            poly = _mm_add_ps(_mm_set1_ps(exp2C3), _mm_mul_ps(t, poly));
+            poly = _mm_add_ps(_mm_set1_ps(exp2C2), _mm_mul_ps(t, poly));
+            poly = _mm_add_ps(_mm_set1_ps(exp2C1), _mm_mul_ps(t, poly));
+            poly = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t, poly));
+            return _mm_mul_ps(poly, scale);
+        }
+
+        static V complexPower(const float* z) noexcept
+        {
+            const V a = _mm_loadu_ps(z);        // r0 i0 r1 i1
+            const V b = _mm_loadu_ps(z + 4);    // r2 i2 r3 i3
+            const V aa = _mm_mul_ps(a, a);
+            const V bb = _mm_mul_ps(b, b);
+            return _mm_add_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(2, 0, 2, 0)),
+                              _mm_shuffle_ps(aa, bb, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        static void loadComplex(const float* z, V& re, V& im) noexcept
+        {
+            const V a = _mm_loadu_ps(z);
+            const V b = _mm_loadu_ps(z + 4);
+            re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        static void loadComplexReversed(const float* z, V& re, V& im) noexcept
+        {
+            loadComplex(z, re, im);
+            re = _mm_shuffle_ps(re, re, _MM_SHUFFLE(0, 1, 2, 3));
+            im = _mm_shuffle_ps(im, im, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+
+
+        static void storeInterleaved(float* dest, V a, V b) noexcept
+        {
+            _mm_storeu_ps(dest,     _mm_unpacklo_ps(a, b));
+            _mm_storeu_ps(dest + 4, _mm_unpackhi_ps(a, b));
+        }
+    };
+}
+
+const DspKernels::Table* DspKernels::detail::getSSE2Table() noexcept
+{
+    static const Table table = makeTable<SSE2Ops>(Isa::sse2);
+    return &table;
+}
+
+#else
+
+const DspKernels::Table* DspKernels::detail::getSSE2Table() noexcept { return nullptr; }
+
+#endif
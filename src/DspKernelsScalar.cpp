@@ -0,0 +1,7 @@
+#include "DspKernelsImpl.h"
+
+const DspKernels::Table* DspKernels::detail::getScalarTable() noexcept
+{
+    static const Table table = makeTable<ScalarOps>(Isa::scalar);
+    return &table;
+}
@@ -0,0 +1,267 @@
+#include "FFTBackend.h"
+#include "MixedRadixFFT.h"
+#include <juce_core/juce_core.h>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace
+{
+    // Fallback: JUCE's own FFT (which picks up IPP, vDSP or FFTW when the
+    // build provides them). Power-of-two sizes only.
+    class JuceFFT : public FFTBackend
+    {
+    public:
+        explicit JuceFFT(int sizeToUse)
+            : fft(juce::roundToInt(std::log2(sizeToUse)))
+        {
+            jassert(fft.getSize() == sizeToUse);
+        }
+
+        const char* getName() const noexcept override { return "juce"; }
+        int getSize() const noexcept override { return fft.getSize(); }
+
+        void performRealForward(float* data) noexcept override
+        {
+            fft.performRealOnlyForwardTransform(data, true);
+        }
+
+        void performForward(const Complex* in, Complex* out) noexcept override
+        {
+            fft.perform(in, out, false);
+        }
+
+    private:
+        juce::dsp::FFT fft;
+    };
+
+    constexpr FFTBackends::Kind allKinds[] = { FFTBackends::Kind::juce, FFTBackends::Kind::mixedRadix };
+
+    bool kindFromName(const juce::String& name, FFTBackends::Kind& kind) noexcept
+    {
+        for (auto k : allKinds)
+        {
+            if (name == FFTBackends::getName(k))
+            {
+                kind = k;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Best-of-N time for one real and one complex transform, the mix the
+    // analyser runs per hop
+    double timeBackend(FFTBackend& backend)
+    {
+        constexpr int warmUpRuns = 2;
+        constexpr int timedRuns = 8;
+
+        const int n = backend.getSize();
+        juce::Random random(0x5eed);
+
+        std::vector<float> real(static_cast<size_t>(n) * 2);
+        std::vector<FFTBackend::Complex> in(static_cast<size_t>(n)), out(static_cast<size_t>(n));
+
+        for (auto& c : in)
+            c = { random.nextFloat() - 0.5f, random.nextFloat() - 0.5f };
+
+        auto runOnce = [&]
+        {
+            for (int i = 0; i < n; ++i)
+                real[static_cast<size_t>(i)] = in[static_cast<size_t>(i)].real();
+
+            backend.performRealForward(real.data());
+            backend.performForward(in.data(), out.data());
+        };
+
+        for (int i = 0; i < warmUpRuns; ++i)
+            runOnce();
+
+        auto best = std::numeric_limits<double>::max();
+        for (int i = 0; i < timedRuns; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            runOnce();
+            const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            best = std::min(best, elapsed);
+        }
+
+        return best;
+    }
+
+    // Size -> winning backend, shared by every plugin instance and mirrored to
+    // disk. Loaded lazily on the first lookup.
+    class PlanCache
+    {
+    public:
+        static PlanCache& getInstance()
+        {
+            static PlanCache cache;
+            return cache;
+        }
+
+        bool lookup(int size, FFTBackends::Kind& kind)
+        {
+            const juce::ScopedLock sl(lock);
+            loadIfNeeded();
+
+            const auto it = plans.find(size);
+            if (it == plans.end())
+                return false;
+
+            kind = it->second;
+            return true;
+        }
+
+        void store(int size, FFTBackends::Kind kind)
+        {
+            const juce::ScopedLock sl(lock);
+            loadIfNeeded();
+
+            plans[size] = kind;
+            save();
+        }
+
+    private:
+        static juce::File getFile()
+        {
+            return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                       .getChildFile("SpectrogramAudio")
+                       .getChildFile("FFTPlans.xml");
+        }
+
+        void loadIfNeeded()
+        {
+            if (loaded)
+                return;
+
+            loaded = true;
+
+            auto xml = juce::parseXML(getFile());
+            if (xml == nullptr || !xml->hasTagName("FFTPlans"))
+                return;
+
+            for (auto* plan : xml->getChildWithTagNameIterator("Plan"))
+            {
+                const int size = plan->getIntAttribute("size");
+                FFTBackends::Kind kind;
+
+                // Ignore entries a backend can no longer serve, e.g. from an
+                // older build
+                if (kindFromName(plan->getStringAttribute("backend"), kind)
+                    && FFTBackends::supportsSize(kind, size))
+                    plans[size] = kind;
+            }
+        }
+
+        void save() const
+        {
+            juce::XmlElement xml("FFTPlans");
+
+            for (const auto& [size, kind] : plans)
+            {
+                auto* plan = xml.createNewChildElement("Plan");
+                plan->setAttribute("size", size);
+                plan->setAttribute("backend", FFTBackends::getName(kind));
+            }
+
+            // A cache: if it can't be written, we simply probe again next session
+            const auto file = getFile();
+            if (file.getParentDirectory().createDirectory().wasOk())
+                xml.writeTo(file);
+        }
+
+        juce::CriticalSection lock;
+        std::map<int, FFTBackends::Kind> plans;
+        bool loaded = false;
+    };
+}
+
+const char* FFTBackends::getName(Kind kind) noexcept
+{
+    switch (kind)
+    {
+        case Kind::juce:       return "juce";
+        case Kind::mixedRadix: return "mixedRadix";
+    }
+    return "juce";
+}
+
+bool FFTBackends::supportsSize(Kind kind, int size) noexcept
+{
+    switch (kind)
+    {
+        case Kind::juce:       return size >= 2 && juce::isPowerOfTwo(size);
+        case Kind::mixedRadix: return MixedRadixFFT::supportsSize(size);
+    }
+    return false;
+}
+
+bool FFTBackends::isSupportedSize(int size) noexcept
+{
+    for (auto kind : allKinds)
+        if (supportsSize(kind, size))
+            return true;
+
+    return false;
+}
+
+std::unique_ptr<FFTBackend> FFTBackends::create(Kind kind, int size)
+{
+    if (!supportsSize(kind, size))
+        return nullptr;
+
+    switch (kind)
+    {
+        case Kind::juce:       return std::make_unique<JuceFFT>(size);
+        case Kind::mixedRadix: return std::make_unique<MixedRadixFFT>(size);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<FFTBackend> FFTBackends::createFastest(int size)
+{
+    jassert(isSupportedSize(size));
+
+    Kind kind = Kind::juce;
+
+    const auto forced = juce::SystemStats::getEnvironmentVariable("SPECTROGRAM_FFT_BACKEND", {}).trim();
+    if (forced.isNotEmpty())
+    {
+        if (kindFromName(forced, kind) && supportsSize(kind, size))
+            return create(kind, size);
+
+        DBG("SPECTROGRAM_FFT_BACKEND=" + forced + " can't do size " + juce::String(size) + ", choosing automatically");
+    }
+
+    auto& cache = PlanCache::getInstance();
+    if (cache.lookup(size, kind))
+        return create(kind, size);
+
+    // Probe every candidate and keep the winner
+    std::unique_ptr<FFTBackend> best;
+    auto bestTime = std::numeric_limits<double>::max();
+
+    for (auto candidate : allKinds)
+    {
+        auto backend = create(candidate, size);
+        if (backend == nullptr)
+            continue;
+
+        const auto elapsed = timeBackend(*backend);
+
+        if (elapsed < bestTime)
+        {
+            bestTime = elapsed;
+            best = std::move(backend);
+            kind = candidate;
+        }
+    }
+
+    if (best != nullptr)
+        cache.store(size, kind);
+
+    return best;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+
+// A forward FFT of one fixed size. The analyser only ever needs two
+// operations, so that's all a backend has to provide.
+class FFTBackend
+{
+public:
+    using Complex = juce::dsp::Complex<float>;
+
+    virtual ~FFTBackend() = default;
+
+    virtual const char* getName() const noexcept = 0;
+    virtual int getSize() const noexcept = 0;
+
+    // Same contract as juce::dsp::FFT::performRealOnlyForwardTransform with
+    // onlyCalculateNonNegativeFrequencies = true: data holds 2 * size floats,
+    // the first size of them real input, and receives bins 0..size/2 as
+    // interleaved complex values.
+    virtual void performRealForward(float* data) noexcept = 0;
+
+    // Out-of-place complex transform of size points (in != out)
+    virtual void performForward(const Complex* in, Complex* out) noexcept = 0;
+};
+
+namespace FFTBackends
+{
+    enum class Kind { juce, mixedRadix };
+
+    const char* getName(Kind kind) noexcept;
+
+    bool supportsSize(Kind kind, int size) noexcept;
+
+    // True if at least one backend can transform this size
+    bool isSupportedSize(int size) noexcept;
+
+    // nullptr if the backend can't handle the size
+    std::unique_ptr<FFTBackend> create(Kind kind, int size);
+
+    // Picks the fastest backend for the size. The first request for a size
+    // runs a short timing probe over every backend that supports it; the
+    // winner is remembered for the session and cached on disk, so later
+    // prepares (and later sessions) skip the probe. The
+    // SPECTROGRAM_FFT_BACKEND environment variable (juce, mixedRadix)
+    // overrides the choice.
+    std::unique_ptr<FFTBackend> createFastest(int size);
+}
@@ -0,0 +1,114 @@
+#include "FrequencyRowMap.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+bool FrequencyRowMap::update(const BinLayout& newLayout, int newNumRows, double newMinHz, double newMaxHz, bool newLogScale)
+{
+    // Exact, as juce::exactlyEqual compares, without pulling in JUCE
+    const std::equal_to<double> exactlyEqual;
+
+    if (newLayout == layout && newNumRows == numRows && exactlyEqual(newMinHz, minHz)
+        && exactlyEqual(newMaxHz, maxHz) && newLogScale == logScale)
+        return false;
+
+    layout = newLayout;
+    numRows = newNumRows;
+    minHz = newMinHz;
+    maxHz = newMaxHz;
+    logScale = newLogScale;
+
+    const int numBins = layout.numBins;
+    rows.assign(static_cast<size_t>(std::max(0, numRows)), Row{});
+    binNorms.resize(static_cast<size_t>(std::max(0, numBins)));
+
+    if (numRows <= 0 || numBins <= 0 || maxHz <= minHz)
+        return true;
+
+    for (int row = 0; row < numRows; ++row)
+    {
+        auto& entry = rows[static_cast<size_t>(row)];
+
+        // The bins whose centres lie within the row
+        const double lowBin = layout.hzToBin(normToHz(static_cast<double>(row) / numRows));
+        const double highBin = layout.hzToBin(normToHz(static_cast<double>(row + 1) / numRows));
+        const int first = std::max(0, static_cast<int>(std::ceil(lowBin)));
+        const int last = std::min(numBins - 1, static_cast<int>(std::ceil(highBin)) - 1);
+
+        if (first <= last)
+        {
+            entry.first = first;
+            entry.num = last - first + 1;
+            continue;
+        }
+
+        // None: the row is narrower than a bin, so it's read between the two
+        // around its centre, up to half a bin beyond the outer ones
+        const double centreBin = layout.hzToBin(getRowHz(row));
+
+        if (centreBin < -0.5 || centreBin > numBins - 0.5)
+            continue;
+
+        entry.first = std::clamp(static_cast<int>(std::floor(centreBin)), 0, std::max(0, numBins - 2));
+        entry.frac = numBins > 1 ? static_cast<float>(std::clamp(centreBin - entry.first, 0.0, 1.0)) : 0.0f;
+    }
+
+    for (int bin = 0; bin < numBins; ++bin)
+        binNorms[static_cast<size_t>(bin)] = static_cast<float>(std::clamp(hzToNorm(layout.binToHz(bin)), 0.0, 1.0));
+
+    return true;
+}
+
+void FrequencyRowMap::apply(const float* frameDb, float* rowsDb, Aggregate aggregate) const noexcept
+{
+    for (int row = 0; row < numRows; ++row)
+        rowsDb[row] = getRow(frameDb, row, aggregate);
+}
+
+float FrequencyRowMap::getRow(const float* frameDb, int row, Aggregate aggregate) const noexcept
+{
+    const auto& entry = rows[static_cast<size_t>(row)];
+
+    if (entry.first < 0)
+        return uncoveredDb;
+
+    const float* bins = frameDb + entry.first;
+
+    if (entry.num == 0)
+        return entry.frac > 0.0f ? bins[0] + (bins[1] - bins[0]) * entry.frac : bins[0];
+
+    if (entry.num == 1)
+        return bins[0];
+
+    if (aggregate == Aggregate::max)
+        return *std::max_element(bins, bins + entry.num);
+
+    // 10^(dB / 10), averaged and back to dB. The mean rather than the sum,
+    // so a flat spectrum reads the same in a row of one bin as of many.
+    constexpr float dbToLogPower = 0.230258509f;
+    float power = 0.0f;
+
+    for (int i = 0; i < entry.num; ++i)
+        power += std::exp(bins[i] * dbToLogPower);
+
+    return std::log(power / static_cast<float>(entry.num)) / dbToLogPower;
+}
+
+double FrequencyRowMap::getRowHz(int row) const noexcept
+{
+    return normToHz((row + 0.5) / numRows);
+}
+
+double FrequencyRowMap::normToHz(double norm) const noexcept
+{
+    return logScale ? minHz * std::pow(maxHz / minHz, norm)
+                    : minHz + (maxHz - minHz) * norm;
+}
+
+double FrequencyRowMap::hzToNorm(double hz) const noexcept
+{
+    if (logScale)
+        return hz > 0.0 ? std::log(hz / minHz) / std::log(maxHz / minHz) : 0.0;
+
+    return (hz - minHz) / (maxHz - minHz);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BinLayout.h"
+#include <vector>
+
+// Resamples a frame's bins onto the rows of a display's frequency axis.
+//
+// The axis runs from minHz at row 0 (the bottom) to maxHz at the top,
+// linearly or logarithmically. A row takes the bins whose centres fall
+// inside it, combined as their maximum, so a narrow peak survives however
+// many bins share its row, or as their mean power, so a flat spectrum reads
+// the same dB at every row. A row narrower than the bin spacing interpolates
+// between the two bins around its centre instead.
+// The tables are built once per layout, row count and axis, so resampling a
+// frame is one pass over its bins with no log or pow.
+//
+// One map serves everything drawn on the same axis: the spectrogram's
+// texture, the RTA and peak-hold curves and the hover readout. Nebula keeps
+// one for its image, and places bins with getBinNorm().
+class FrequencyRowMap
+{
+public:
+    enum class Aggregate
+    {
+        max,
+        meanPower
+    };
+
+    // Rows outside the frame's band, below any floor the display can show
+    static constexpr float uncoveredDb = -140.0f;
+
+    // Rebuilds the tables for a new layout, row count or axis. Returns true
+    // if anything changed.
+    bool update(const BinLayout& newLayout, int newNumRows, double newMinHz, double newMaxHz, bool newLogScale);
+
+    int getNumRows() const noexcept { return numRows; }
+    const BinLayout& getLayout() const noexcept { return layout; }
+
+    // Fills rowsDb[0, numRows) from frameDb[0, layout.numBins)
+    void apply(const float* frameDb, float* rowsDb, Aggregate aggregate) const noexcept;
+
+    // One row of apply()
+    float getRow(const float* frameDb, int row, Aggregate aggregate) const noexcept;
+
+    // The frequency at a row's centre
+    double getRowHz(int row) const noexcept;
+
+    // Where a bin's centre sits on the axis, from 0 at the bottom to 1 at
+    // the top, clamped to the ends
+    float getBinNorm(int bin) const noexcept { return binNorms[static_cast<size_t>(bin)]; }
+
+private:
+    // Bins [first, first + num), or with num == 0 the bins first and
+    // first + 1 mixed by frac; first < 0 when no bin is near
+    struct Row
+    {
+        int first = -1;
+        int num = 0;
+        float frac = 0.0f;
+    };
+
+    double normToHz(double norm) const noexcept;
+    double hzToNorm(double hz) const noexcept;
+
+    BinLayout layout;
+    int numRows = 0;
+    double minHz = 0.0, maxHz = 0.0;
+    bool logScale = false;
+
+    std::vector<Row> rows;
+    std::vector<float> binNorms;
+};
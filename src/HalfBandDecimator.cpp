@@ -0,0 +1,90 @@
+#include "HalfBandDecimator.h"
+#include "DspKernels.h"
+#include "WindowBank.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Kaiser beta 9 reaches about this, so the WindowBank's Kaiser tables
+    // shape the filters
+    constexpr double stopbandDb = 90.0;
+}
+
+std::vector<float> HalfBandDecimator::design(double passbandEdge)
+{
+    const double transition = juce::jmax(0.05, 0.5 - 2.0 * passbandEdge);
+    const double estimate = (stopbandDb - 8.0) / (2.285 * juce::MathConstants<double>::twoPi * transition) + 1.0;
+
+    // Lengths of the form 4K - 1 put a nonzero tap at each end
+    const int numOddTaps = juce::jlimit(2, (maxTaps + 1) / 4, (static_cast<int>(std::ceil(estimate)) + 4) / 4);
+    const int length = 4 * numOddTaps - 1;
+    const int middle = length / 2;
+
+    const auto kaiser = WindowBank::get(WindowBank::Type::kaiser, length);
+
+    std::vector<float> taps(static_cast<size_t>(numOddTaps));
+    double sum = 0.0;
+
+    for (int k = 0; k < numOddTaps; ++k)
+    {
+        const double n = 2 * k + 1;
+        const double x = juce::MathConstants<double>::halfPi * n;
+        const double h = 0.5 * std::sin(x) / x * kaiser->data[middle + 2 * k + 1];
+        taps[static_cast<size_t>(k)] = static_cast<float>(h);
+        sum += h;
+    }
+
+    // Exactly unity gain at DC: 0.5 + 2 * sum(odd taps) = 1
+    for (auto& t : taps)
+        t = static_cast<float>(t * 0.25 / sum);
+
+    return taps;
+}
+
+HalfBandDecimator::HalfBandDecimator()
+{
+    const size_t lineSize = maxTaps - 1 + maxBlockSize;
+
+    line.resize(lineSize);
+    centrePhase.resize(lineSize / 2 + 1);
+    tapPhase.resize(lineSize / 2 + 1);
+}
+
+void HalfBandDecimator::reset() noexcept
+{
+    std::fill(line.begin(), line.end(), 0.0f);
+    firstOutput = 1;
+}
+
+int HalfBandDecimator::process(const std::vector<float>& oddTaps, const float* in, int num, float* out) noexcept
+{
+    jassert(num <= maxBlockSize);
+
+    // With the centre tap at 0.5 and every other even tap zero, an output
+    // reads one phase of the line at its centre and the other phase at the
+    // odd taps, so the line is split into its two phases and every tap
+    // becomes a contiguous run over the outputs.
+    const int numOddTaps = static_cast<int>(oddTaps.size());
+    const int carry = 4 * numOddTaps - 2;
+    const int total = carry + num;
+
+    std::copy(in, in + num, line.data() + carry);
+
+    // Starting the split at the first output's parity puts the odd-tap
+    // phase first, and output o's centre at centrePhase[numOddTaps - 1 + o]
+    const int first = firstOutput;
+    const int numOut = num > first ? (num - first + 1) / 2 : 0;
+    const int numPairs = (total - first) / 2;
+
+    const auto& kernels = DspKernels::get();
+    kernels.deinterleave(tapPhase.data(), centrePhase.data(), line.data() + first, numPairs);
+    kernels.halfBandFilter(out, centrePhase.data() + numOddTaps - 1, tapPhase.data() + numOddTaps,
+                           oddTaps.data(), numOddTaps, numOut);
+
+    // Keep the newest length - 1 inputs for the next block
+    std::copy(line.data() + num, line.data() + total, line.data());
+    firstOutput = (first + num) & 1;
+
+    return numOut;
+}
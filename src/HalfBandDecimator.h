@@ -0,0 +1,42 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+// Decimates a real stream by 2 with a symmetric half-band FIR. Every other
+// tap of a half-band filter is zero and the centre one is 0.5, so only the
+// odd-indexed taps are stored and multiplied. The filter state carries over
+// between blocks, so a stream can be fed in pieces of any size up to
+// maxBlockSize.
+class HalfBandDecimator
+{
+public:
+    // Longest filter design() returns
+    static constexpr int maxTaps = 63;
+
+    static constexpr int maxBlockSize = 8192;
+
+    // Odd taps h[1], h[3], ... of a Kaiser-windowed half-band filter whose
+    // passband reaches passbandEdge (as a fraction of its input rate) and
+    // whose stopband starts at 0.5 - passbandEdge, with about 90 dB of
+    // rejection and exactly unity gain at DC
+    static std::vector<float> design(double passbandEdge);
+
+    // Allocates for maxTaps and maxBlockSize; nothing allocates afterwards
+    HalfBandDecimator();
+
+    void reset() noexcept;
+
+    // Filters num inputs with the odd taps from design() and writes every
+    // second output. Returns how many were written: num / 2, or one more
+    // when the block completes a pair left over from the previous one.
+    int process(const std::vector<float>& oddTaps, const float* in, int num, float* out) noexcept;
+
+private:
+    // The last length - 1 inputs followed by the current block, and the two
+    // phases it's split into
+    std::vector<float> line, centrePhase, tapPhase;
+
+    // 0 or 1: which input of the next block completes a pair
+    int firstOutput = 1;
+};
@@ -0,0 +1,244 @@
+#include "MixedRadixFFT.h"
+#include <cmath>
+
+namespace
+{
+    using Complex = FFTBackend::Complex;
+
+    // Spelled out rather than std::complex's operator*, which has to handle
+    // inf/nan and isn't inlined without -ffast-math
+    inline Complex mul(Complex a, Complex b) noexcept
+    {
+        return { a.real() * b.real() - a.imag() * b.imag(),
+                 a.real() * b.imag() + a.imag() * b.real() };
+    }
+
+    // -i * a
+    inline Complex mulNegI(Complex a) noexcept
+    {
+        return { a.imag(), -a.real() };
+    }
+
+    // In-place forward DFT of radix points
+    template <size_t Radix>
+    inline void butterfly(Complex* a) noexcept;
+
+    template <>
+    inline void butterfly<2>(Complex* a) noexcept
+    {
+        const auto t = a[1];
+        a[1] = a[0] - t;
+        a[0] = a[0] + t;
+    }
+
+    template <>
+    inline void butterfly<3>(Complex* a) noexcept
+    {
+        constexpr float sin60 = 0.866025403784438647f;
+
+        const auto sum = a[1] + a[2];
+        const auto t = a[0] - sum * 0.5f;
+        const auto u = mulNegI(a[1] - a[2]) * sin60;
+
+        a[0] = a[0] + sum;
+        a[1] = t + u;
+        a[2] = t - u;
+    }
+
+    template <>
+    inline void butterfly<4>(Complex* a) noexcept
+    {
+        const auto s02 = a[0] + a[2], d02 = a[0] - a[2];
+        const auto s13 = a[1] + a[3], d13 = mulNegI(a[1] - a[3]);
+
+        a[0] = s02 + s13;
+        a[1] = d02 + d13;
+        a[2] = s02 - s13;
+        a[3] = d02 - d13;
+    }
+
+    template <>
+    inline void butterfly<5>(Complex* a) noexcept
+    {
+        constexpr float c1 = 0.309016994374947424f;     // cos(2 pi / 5)
+        constexpr float c2 = -0.809016994374947424f;    // cos(4 pi / 5)
+        constexpr float s1 = 0.951056516295153572f;     // sin(2 pi / 5)
+        constexpr float s2 = 0.587785252292473129f;     // sin(4 pi / 5)
+
+        const auto s14 = a[1] + a[4], d14 = a[1] - a[4];
+        const auto s23 = a[2] + a[3], d23 = a[2] - a[3];
+
+        const auto r1 = a[0] + s14 * c1 + s23 * c2;
+        const auto r2 = a[0] + s14 * c2 + s23 * c1;
+        const auto i1 = mulNegI(d14 * s1 + d23 * s2);
+        const auto i2 = mulNegI(d14 * s2 - d23 * s1);
+
+        a[0] = a[0] + s14 + s23;
+        a[1] = r1 + i1;
+        a[4] = r1 - i1;
+        a[2] = r2 + i2;
+        a[3] = r2 - i2;
+    }
+
+    // One Stockham pass: radix-point DFTs over legs span apart, each output
+    // leg j > 0 rotated by exp(-2 pi i j p / (radix * span))
+    template <size_t Radix>
+    void runPass(const Complex* src, Complex* dst, int span, int stride, const Complex* twiddles) noexcept
+    {
+        constexpr int radix = static_cast<int>(Radix);
+
+        for (int p = 0; p < span; ++p)
+        {
+            const Complex* tw = twiddles + p * (radix - 1);
+
+            for (int q = 0; q < stride; ++q)
+            {
+                Complex a[Radix];
+                for (int k = 0; k < radix; ++k)
+                    a[k] = src[q + stride * (p + k * span)];
+
+                butterfly<Radix>(a);
+
+                Complex* out = dst + q + stride * radix * p;
+                out[0] = a[0];
+                for (int j = 1; j < radix; ++j)
+                    out[stride * j] = mul(a[j], tw[j - 1]);
+            }
+        }
+    }
+
+    // Factors n into radix 4, 2, 3 and 5 passes; returns false if anything is left over
+    bool factorise(int n, std::vector<int>& radices)
+    {
+        radices.clear();
+
+        if (n < 2)
+            return false;
+
+        while (n % 4 == 0) { radices.push_back(4); n /= 4; }
+        while (n % 2 == 0) { radices.push_back(2); n /= 2; }
+        while (n % 3 == 0) { radices.push_back(3); n /= 3; }
+        while (n % 5 == 0) { radices.push_back(5); n /= 5; }
+
+        return n == 1;
+    }
+}
+
+bool MixedRadixFFT::supportsSize(int n) noexcept
+{
+    // The real transform runs at half size, so that has to factor too
+    std::vector<int> radices;
+    return n % 2 == 0 && factorise(n, radices) && factorise(n / 2, radices);
+}
+
+MixedRadixFFT::MixedRadixFFT(int sizeToUse)
+    : size(sizeToUse)
+{
+    jassert(supportsSize(size));
+
+    fullPlan = makePlan(size);
+    halfPlan = makePlan(size / 2);
+
+    realTwiddles.resize(static_cast<size_t>(size / 2 + 1));
+    for (size_t k = 0; k < realTwiddles.size(); ++k)
+    {
+        const double angle = -2.0 * juce::MathConstants<double>::pi * static_cast<double>(k) / size;
+        realTwiddles[k] = { static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+    }
+
+    work.resize(static_cast<size_t>(size));
+    halfSpectrum.resize(static_cast<size_t>(size / 2));
+}
+
+MixedRadixFFT::Plan MixedRadixFFT::makePlan(int n)
+{
+    Plan plan;
+    plan.size = n;
+
+    std::vector<int> radices;
+    factorise(n, radices);
+
+    int length = n;
+    int stride = 1;
+
+    for (int radix : radices)
+    {
+        Pass pass;
+        pass.radix = radix;
+        pass.span = length / radix;
+        pass.stride = stride;
+        pass.twiddles.resize(static_cast<size_t>(pass.span * (radix - 1)));
+
+        for (int p = 0; p < pass.span; ++p)
+        {
+            for (int j = 1; j < radix; ++j)
+            {
+                const double angle = -2.0 * juce::MathConstants<double>::pi
+                                   * static_cast<double>(j * p) / static_cast<double>(length);
+                pass.twiddles[static_cast<size_t>(p * (radix - 1) + j - 1)]
+                    = { static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)) };
+            }
+        }
+
+        plan.passes.push_back(std::move(pass));
+        length /= radix;
+        stride *= radix;
+    }
+
+    return plan;
+}
+
+void MixedRadixFFT::execute(const Plan& plan, const Complex* in, Complex* out, Complex* scratch) noexcept
+{
+    const int numPasses = static_cast<int>(plan.passes.size());
+    const Complex* src = in;
+
+    for (int i = 0; i < numPasses; ++i)
+    {
+        // Ping-pong between out and scratch so the last pass lands in out
+        Complex* dst = ((numPasses - 1 - i) % 2 == 0) ? out : scratch;
+        const auto& pass = plan.passes[static_cast<size_t>(i)];
+
+        switch (pass.radix)
+        {
+            case 2: runPass<2>(src, dst, pass.span, pass.stride, pass.twiddles.data()); break;
+            case 3: runPass<3>(src, dst, pass.span, pass.stride, pass.twiddles.data()); break;
+            case 4: runPass<4>(src, dst, pass.span, pass.stride, pass.twiddles.data()); break;
+            case 5: runPass<5>(src, dst, pass.span, pass.stride, pass.twiddles.data()); break;
+            default: jassertfalse; break;
+        }
+
+        src = dst;
+    }
+}
+
+void MixedRadixFFT::performForward(const Complex* in, Complex* out) noexcept
+{
+    jassert(in != out);
+    execute(fullPlan, in, out, work.data());
+}
+
+void MixedRadixFFT::performRealForward(float* data) noexcept
+{
+    const int half = size / 2;
+
+    // Even/odd samples as the real/imaginary parts of a half-size transform
+    execute(halfPlan, reinterpret_cast<const Complex*>(data), halfSpectrum.data(), work.data());
+
+    // Split Z = FFT(x_even + i x_odd) into the spectrum of x:
+    //   X[k] = E[k] + exp(-2 pi i k / N) O[k]
+    //   E[k] = (Z[k] + conj(Z[M - k])) / 2,  O[k] = -i (Z[k] - conj(Z[M - k])) / 2
+    // The input has been consumed, so X is written straight over it.
+    auto* dest = reinterpret_cast<Complex*>(data);
+
+    for (int k = 0; k <= half; ++k)
+    {
+        const auto z = halfSpectrum[static_cast<size_t>(k % half)];
+        const auto zc = std::conj(halfSpectrum[static_cast<size_t>((half - k) % half)]);
+
+        const auto even = (z + zc) * 0.5f;
+        const auto odd = mulNegI(z - zc) * 0.5f;
+
+        dest[k] = even + mul(realTwiddles[static_cast<size_t>(k)], odd);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FFTBackend.h"
+#include <vector>
+
+// In-house FFT for any size whose prime factors are 2, 3 and 5, e.g.
+// 6144 = 3 * 2^11 or 5120 = 5 * 2^10. It's a Stockham autosort transform: each
+// radix-4/2/3/5 pass reads one buffer and writes the other in an order that
+// leaves the result in natural order, so there's no bit-reversal pass and
+// the inner loop always walks contiguous memory.
+//
+// A real transform of size N runs as a complex transform of size N/2 over the
+// even/odd sample pairs, followed by one split pass.
+class MixedRadixFFT : public FFTBackend
+{
+public:
+    explicit MixedRadixFFT(int size);
+
+    static bool supportsSize(int size) noexcept;
+
+    const char* getName() const noexcept override { return "mixedRadix"; }
+    int getSize() const noexcept override { return size; }
+
+    void performRealForward(float* data) noexcept override;
+    void performForward(const Complex* in, Complex* out) noexcept override;
+
+private:
+    struct Pass
+    {
+        int radix = 0;
+        int span = 0;      // m: butterflies per group, input stride between legs
+        int stride = 0;    // s: contiguous run sharing one twiddle set
+        std::vector<Complex> twiddles;    // (radix - 1) per butterfly position
+    };
+
+    struct Plan
+    {
+        int size = 0;
+        std::vector<Pass> passes;
+    };
+
+    static Plan makePlan(int n);
+    static void execute(const Plan& plan, const Complex* in, Complex* out, Complex* work) noexcept;
+
+    int size;
+    Plan fullPlan, halfPlan;
+
+    // exp(-2 pi i k / size) for the real split, k in 0..size/2
+    std::vector<Complex> realTwiddles;
+
+    std::vector<Complex> work, halfSpectrum;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixedRadixFFT)
+};
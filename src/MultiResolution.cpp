@@ -0,0 +1,249 @@
+#include "MultiResolution.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // Every band below the top one is used up to this fraction of its rate,
+    // and down to half of it, where the band below takes over
+    constexpr double bandTopFraction = 0.4;
+
+    std::atomic<uint64_t> nextPlanId{ 1 };
+}
+
+std::shared_ptr<const MultiResolution::Plan> MultiResolution::createPlan(double sampleRate, int fftSize, int hopSize,
+                                                                        WindowBank::Type windowType)
+{
+    jassert(sampleRate > 2.0 * lowestHz && fftSize > 0 && hopSize > 0);
+
+    auto plan = std::make_shared<Plan>();
+    plan->id = nextPlanId.fetch_add(1);
+    plan->sampleRate = sampleRate;
+
+    // Halve until the top band's window is short, keeping the lowest band's
+    // window as long as the FFT size
+    int length = fftSize, numBands = 1;
+
+    while (length > maxBandLength && length % 2 == 0 && numBands < maxBands)
+    {
+        length /= 2;
+        ++numBands;
+    }
+
+    jassert(length <= maxBandLength);
+
+    plan->numBands = numBands;
+    plan->bandLength = length;
+
+    // Never less often than every half window, so no input goes untransformed
+    plan->transformHop = juce::jlimit(1, length / 2, hopSize);
+
+    // The decimated band must stay clean up to bandTopFraction of its own
+    // rate, half that of the filter's input
+    plan->decimatorTaps = HalfBandDecimator::design(0.5 * bandTopFraction);
+
+    plan->window = WindowBank::get(windowType, length);
+    plan->fft = FFTBackends::createFastest(length);
+
+    const auto hann = WindowBank::get(WindowBank::Type::hann, length);
+    plan->normalisationDb = 20.0f * std::log10(hann->coherentGain / plan->window->coherentGain)
+                          - 20.0f * std::log10(static_cast<float>(length));
+
+    // Whole bins per octave up to Nyquist
+    const double octaves = std::log2(sampleRate * 0.5 / lowestHz);
+    const int numBins = static_cast<int>(std::floor(octaves * binsPerOctave)) + 1;
+
+    plan->layout.numBins = numBins;
+    plan->layout.minHz = lowestHz;
+    plan->layout.maxHz = lowestHz * std::exp2(static_cast<double>(numBins - 1) / binsPerOctave);
+    plan->layout.logSpaced = true;
+
+    const double halfBinRatio = std::exp2(0.5 / binsPerOctave);
+    const int topBin = length / 2;
+    plan->sources.resize(static_cast<size_t>(numBins));
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const double hz = plan->layout.binToHz(i);
+
+        // The lowest band that still reaches this frequency
+        int band = numBands - 1;
+        while (band > 0 && hz > bandTopFraction * sampleRate / (1 << band))
+            --band;
+
+        const double sourceBinHz = sampleRate / (1 << band) / length;
+        auto& source = plan->sources[static_cast<size_t>(i)];
+        source.band = band;
+
+        // Source bins whose centres fall within this output bin
+        const int first = juce::jmax(0, static_cast<int>(std::ceil(hz / halfBinRatio / sourceBinHz)));
+        const int last = juce::jmin(topBin, static_cast<int>(std::floor(hz * halfBinRatio / sourceBinHz)));
+
+        if (last >= first)
+        {
+            source.firstSourceBin = first;
+            source.numSourceBins = last - first + 1;
+        }
+        else
+        {
+            const double position = hz / sourceBinHz;
+            const int below = juce::jlimit(0, topBin - 1, static_cast<int>(position));
+            source.firstSourceBin = below;
+            source.fraction = static_cast<float>(juce::jlimit(0.0, 1.0, position - below));
+        }
+    }
+
+    return plan;
+}
+
+//==============================================================================
+MultiResolution::MultiResolution()
+{
+    for (auto& s : scratch)
+        s.resize(HalfBandDecimator::maxBlockSize);
+
+    for (size_t b = 0; b < maxBands; ++b)
+    {
+        history[b].resize(2 * maxBandLength);
+        bandDb[b].resize(maxBandBins);
+    }
+
+    fftWork.resize(2 * maxBandLength);
+    transformDb.resize(maxBandBins);
+
+    reset();
+}
+
+void MultiResolution::prepare(const Plan& plan) noexcept
+{
+    if (plan.id == preparedPlanId)
+        return;
+
+    reset();
+    preparedPlanId = plan.id;
+}
+
+void MultiResolution::reset() noexcept
+{
+    for (auto& decimator : decimators)
+        decimator.reset();
+
+    for (size_t b = 0; b < maxBands; ++b)
+    {
+        std::fill(history[b].begin(), history[b].end(), 0.0f);
+        std::fill(bandDb[b].begin(), bandDb[b].end(), DspKernels::floorDb);
+    }
+
+    historyPos.fill(0);
+    samplesSinceTransform.fill(0);
+    fresh.fill(false);
+}
+
+void MultiResolution::push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int num = juce::jmin(HalfBandDecimator::maxBlockSize, numSamples - done);
+        pushBlock(plan, left + done, right != nullptr ? right + done : nullptr, num);
+        done += num;
+    }
+}
+
+void MultiResolution::pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept
+{
+    const float* in = left;
+
+    if (right != nullptr)
+    {
+        DspKernels::mixToMono(scratch[0].data(), left, right, num);
+        in = scratch[0].data();
+    }
+
+    appendToBand(plan, 0, in, num);
+
+    // Each band is the one above decimated by 2; the two scratch buffers
+    // take turns as input and output
+    for (int band = 1; band < plan.numBands; ++band)
+    {
+        float* out = scratch[static_cast<size_t>(band) & 1].data();
+        num = decimators[static_cast<size_t>(band) - 1].process(plan.decimatorTaps, in, num, out);
+        in = out;
+
+        appendToBand(plan, band, in, num);
+    }
+}
+
+void MultiResolution::appendToBand(const Plan& plan, int band, const float* samples, int num) noexcept
+{
+    const auto b = static_cast<size_t>(band);
+    auto* line = history[b].data();
+    const int length = plan.bandLength;
+
+    for (int i = 0; i < num; ++i)
+    {
+        line[historyPos[b]] = line[historyPos[b] + length] = samples[i];
+
+        if (++historyPos[b] == length)
+            historyPos[b] = 0;
+
+        if (++samplesSinceTransform[b] == plan.transformHop)
+        {
+            transformBand(plan, band);
+            samplesSinceTransform[b] = 0;
+        }
+    }
+}
+
+void MultiResolution::transformBand(const Plan& plan, int band) noexcept
+{
+    const auto b = static_cast<size_t>(band);
+    const auto& kernels = DspKernels::get();
+    const int length = plan.bandLength;
+    const int numBins = length / 2 + 1;
+    auto* work = fftWork.data();
+
+    // Oldest to newest starts at the write position
+    kernels.applyWindow(work, history[b].data() + historyPos[b], plan.window->data, length);
+    std::fill(work + length, work + 2 * length, 0.0f);
+
+    plan.fft->performRealForward(work);
+
+    if (!fresh[b])
+    {
+        kernels.complexToDb(work, bandDb[b].data(), numBins, plan.normalisationDb);
+        fresh[b] = true;
+    }
+    else
+    {
+        // A frame shows the loudest of the transforms it spans, so a
+        // transient between frames isn't lost
+        kernels.complexToDb(work, transformDb.data(), numBins, plan.normalisationDb);
+        kernels.maxWithDecay(bandDb[b].data(), transformDb.data(), numBins, 0.0f, DspKernels::floorDb);
+    }
+}
+
+void MultiResolution::analyse(const Plan& plan, float* destDb) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    const int numBins = plan.layout.numBins;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto& source = plan.sources[static_cast<size_t>(i)];
+        const float* bins = bandDb[static_cast<size_t>(source.band)].data() + source.firstSourceBin;
+
+        if (source.numSourceBins > 0)
+            destDb[i] = *std::max_element(bins, bins + source.numSourceBins);
+        else
+            destDb[i] = bins[0] + (bins[1] - bins[0]) * source.fraction;
+    }
+
+    // Bands that aren't transformed again before the next frame keep
+    // showing their last spectrum
+    fresh.fill(false);
+}
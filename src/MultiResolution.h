@@ -0,0 +1,136 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "BinLayout.h"
+#include "FFTBackend.h"
+#include "HalfBandDecimator.h"
+#include "WindowBank.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Multi-resolution analysis for a log-frequency display. A single FFT spends
+// its bins evenly across the band, so a size long enough for the bass has
+// far more bins than the top octaves can show and smears their transients
+// over the whole window. Here the input is split into octave bands instead:
+// band 0 runs at the input rate, and each band below it is the one above
+// decimated by 2, all transformed at the same short length. Each band's
+// window is therefore twice as long in time as the one above it, so the
+// lowest band resolves as finely as the selected FFT size while the top
+// band keeps the short window's time resolution.
+//
+// A band covers from 0.2 to 0.4 of its own rate (band 0 up to Nyquist, the
+// lowest band down to DC), which keeps it clear of the decimators'
+// transition bands. The bands' spectra are merged into one log-spaced frame:
+// an output bin takes the loudest of the source bins under it where the band
+// is denser than the display, and interpolates between the two nearest
+// where it's sparser.
+//
+// Each band is transformed whenever its history has moved on by
+// Plan::transformHop of its own samples (at most half a window), so the
+// lower bands are transformed less often, and a frame holds the loudest of a
+// band's transforms since the previous frame. For an 8192 FFT size that's
+// four bands of 1024, transformed every 512 of their own samples: 16 + 8 +
+// 4 + 2 = 30 transforms per 8192 input samples. That's about as many samples
+// as the four 8192 transforms a single FFT needs at 75% overlap, but each
+// is shorter: at N log2 N apiece, 30 * 1024 * 10 against 4 * 8192 * 13,
+// around three quarters of the work.
+class MultiResolution
+{
+public:
+    // Bands are halved from the full FFT size until they're no longer than
+    // this, so the top band's window is never longer
+    static constexpr int maxBandLength = 1024;
+    static constexpr int maxBands = 4;
+
+    // Spacing of the merged frame, from lowestHz up to Nyquist
+    static constexpr int binsPerOctave = 96;
+    static constexpr double lowestHz = 20.0;
+
+    // Immutable once built; shared through the analyser's published Config
+    struct Plan
+    {
+        uint64_t id = 0;
+
+        double sampleRate = 0.0;
+        int numBands = 0;
+        int bandLength = 0;         // transform size of every band
+        int transformHop = 0;       // band samples between transforms
+
+        // Odd taps of the half-band filter between each band and the next
+        std::vector<float> decimatorTaps;
+
+        std::shared_ptr<const WindowBank::Table> window;
+        std::shared_ptr<FFTBackend> fft;
+
+        // A band's level relative to a full-band transform of its length,
+        // calibrated to Hann like the analyser's own frames
+        float normalisationDb = 0.0f;
+
+        // Where each output bin reads from: the maximum of numSourceBins bins
+        // from firstSourceBin of its band, or, when numSourceBins is 0, the
+        // value fraction of the way from firstSourceBin to the next
+        struct Source
+        {
+            int band = 0;
+            int firstSourceBin = 0;
+            int numSourceBins = 0;
+            float fraction = 0.0f;
+        };
+
+        std::vector<Source> sources;
+        BinLayout layout;
+    };
+
+    // fftSize sets the lowest band's resolution; hopSize is the analyser's
+    // frame hop in input samples
+    static std::shared_ptr<const Plan> createPlan(double sampleRate, int fftSize, int hopSize,
+                                                  WindowBank::Type windowType);
+
+    // Allocates for the largest plan; nothing allocates afterwards
+    MultiResolution();
+
+    // Clears the filters and history when plan isn't the one the state was
+    // built for; otherwise does nothing
+    void prepare(const Plan& plan) noexcept;
+
+    // Forgets everything, e.g. after input was skipped
+    void reset() noexcept;
+
+    // Feeds new input through the decimators, transforming each band as its
+    // hop comes round. right may be nullptr for mono input; otherwise the
+    // two are mixed down.
+    void push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept;
+
+    // Merges the bands into plan.layout.numBins dB values
+    void analyse(const Plan& plan, float* destDb) noexcept;
+
+private:
+    static constexpr int maxBandBins = maxBandLength / 2 + 1;
+
+    void pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept;
+    void appendToBand(const Plan& plan, int band, const float* samples, int num) noexcept;
+    void transformBand(const Plan& plan, int band) noexcept;
+
+    std::array<HalfBandDecimator, maxBands - 1> decimators;
+    std::array<std::vector<float>, 2> scratch;
+
+    // Per band: history written twice bandLength apart so the latest window
+    // is always contiguous from historyPos, and the samples since its last
+    // transform
+    std::array<std::vector<float>, maxBands> history;
+    std::array<int, maxBands> historyPos{};
+    std::array<int, maxBands> samplesSinceTransform{};
+
+    // Per band: the loudest of its transforms since the last frame, or the
+    // last one if there were none. fresh is set once a transform has landed
+    // since the last frame, so the next one is max-combined rather than
+    // replacing it.
+    std::array<std::vector<float>, maxBands> bandDb;
+    std::array<bool, maxBands> fresh{};
+
+    std::vector<float> fftWork, transformDb;
+
+    uint64_t preparedPlanId = 0;
+};
@@ -1,10 +1,10 @@
 #include "PluginEditor.h"
+#include "DspKernels.h"
 #include <cmath>
+#include <cstring>
 
 using namespace juce::gl;
 
-static constexpr double minLogFreq = 20.0;
-
 // ── GLSL Shaders ────────────────────────────────────────────────────────
 
 static const char* vertexShaderSource = R"(
@@ -25,14 +25,11 @@ static const char* fragmentShaderSource = R"(
 
     uniform sampler2D magnitudeTexture;
     uniform float scrollOffset;
+    uniform float textureDbScale;
+    uniform float textureDbOffset;
     uniform int colourMapType;
     uniform float dbFloor;
     uniform float dbCeiling;
-    uniform int useLogScale;
-    uniform float logMinFreq;
-    uniform float nyquist;
-    uniform float zoomMinFreq;
-    uniform float zoomMaxFreq;
 
     vec3 heatMap(float t)
     {
@@ -106,26 +103,14 @@ static const char* fragmentShaderSource = R"(
 
     void main()
     {
+        // The texture is time-major: each row is a frame, so s runs over
+        // frequency and t over the ring of frames
         float x = vTexCoord.x + scrollOffset;
         if (x >= 1.0) x -= 1.0;
 
-        // Frequency mapping with zoom support
-        float y = vTexCoord.y;
-
-        // Map from display [0,1] to frequency using zoom range
-        float freq;
-        if (useLogScale == 1)
-        {
-            freq = zoomMinFreq * pow(zoomMaxFreq / zoomMinFreq, y);
-        }
-        else
-        {
-            freq = zoomMinFreq + (zoomMaxFreq - zoomMinFreq) * y;
-        }
-        // Map frequency to texture coordinate (linear 0..nyquist)
-        y = freq / nyquist;
-
-        float db = texture(magnitudeTexture, vec2(x, y)).r;
+        // The rows were resampled onto the display's frequency axis on the
+        // CPU, a texel per pixel row, so s is simply the height
+        float db = texture(magnitudeTexture, vec2(vTexCoord.y, x)).r * textureDbScale + textureDbOffset;
         float t = clamp((db - dbFloor) / (dbCeiling - dbFloor), 0.0, 1.0);
 
         vec3 colour;
@@ -238,8 +223,10 @@ SpectrogramEditor::SpectrogramEditor(SpectrogramProcessor& p)
     bloomIntensity   = s.bloomIntensity;
     bloomThreshold   = s.bloomThreshold;
     nebulaMode       = s.nebulaMode;
+    aggregateMean    = s.aggregateMean;
 
     processorRef.nebulaActive.store(nebulaMode, std::memory_order_relaxed);
+    nebulaAccum.assign(static_cast<size_t>(nebulaTexW) * nebulaTexH * 3, 0.0f);
 
     setSize(s.editorWidth, s.editorHeight);
     setResizable(true, true);
@@ -249,11 +236,16 @@ SpectrogramEditor::SpectrogramEditor(SpectrogramProcessor& p)
 
     // Set control states to match restored settings
     fftSizeBox.setSelectedId(s.fftSizeId, juce::dontSendNotification);
+    engineBox.setSelectedId(s.engineId, juce::dontSendNotification);
+    hopBox.setSelectedId(s.slidingHopId, juce::dontSendNotification);
+    historyFormatBox.setSelectedId(s.historyFormatId, juce::dontSendNotification);
     overlapBox.setSelectedId(s.overlapId, juce::dontSendNotification);
     windowBox.setSelectedId(s.windowId, juce::dontSendNotification);
     colourMapBox.setSelectedId(s.colourMapId, juce::dontSendNotification);
     scaleButton.setToggleState(logScale, juce::dontSendNotification);
     scaleButton.setButtonText(logScale ? "Log" : "Linear");
+    aggregateButton.setToggleState(aggregateMean, juce::dontSendNotification);
+    aggregateButton.setButtonText(aggregateMean ? "Mean" : "Max");
     dbFloorSlider.setValue(dbFloor, juce::dontSendNotification);
     dbCeilingSlider.setValue(dbCeiling, juce::dontSendNotification);
     zoomMinSlider.setValue(zoomMinFreq, juce::dontSendNotification);
@@ -273,10 +265,13 @@ SpectrogramEditor::SpectrogramEditor(SpectrogramProcessor& p)
 
     lastTimerTime = juce::Time::getMillisecondCounterHiRes() / 1000.0;
     startTimerHz(60);
+
+    processorRef.setEditorOpen(true);
 }
 
 SpectrogramEditor::~SpectrogramEditor()
 {
+    processorRef.setEditorOpen(false);
     stopTimer();
     glContext.detach();
     setLookAndFeel(nullptr);
@@ -359,14 +354,9 @@ void SpectrogramEditor::newOpenGLContextCreated()
 
     glBindVertexArray(0);
 
-    // Create spectrogram texture
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // The spectrogram texture is created at its first upload, once its size
+    // is known
+    textureAllocWidth = textureAllocHeight = 0;
 
     // Create nebula texture
     glGenTextures(1, &nebulaTexId);
@@ -375,10 +365,94 @@ void SpectrogramEditor::newOpenGLContextCreated()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    nebulaAccum.assign(static_cast<size_t>(nebulaTexW) * nebulaTexH * 3, 0.0f);
+    const std::vector<float> blank(static_cast<size_t>(nebulaTexW) * nebulaTexH * 3, 0.0f);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, nebulaTexW, nebulaTexH, 0,
-                 GL_RGB, GL_FLOAT, nebulaAccum.data());
+                 GL_RGB, GL_FLOAT, blank.data());
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    // The message thread can send texture updates from here on
+    spectrogramStream.create();
+    nebulaStream.create();
+}
+
+// The texture holds the history's values as they are stored: floats as
+// floats, codes as normalised texels the shader scales back to dB
+static void getTexturePixelFormat(DbFormat::Type format, GLenum& internalFormat, GLenum& type) noexcept
+{
+    switch (format)
+    {
+        case DbFormat::Type::float16: internalFormat = GL_R16F; type = GL_HALF_FLOAT;     return;
+        case DbFormat::Type::unorm16: internalFormat = GL_R16;  type = GL_UNSIGNED_SHORT; return;
+        case DbFormat::Type::unorm8:  internalFormat = GL_R8;   type = GL_UNSIGNED_BYTE;  return;
+        case DbFormat::Type::float32: break;
+    }
+
+    internalFormat = GL_R32F;
+    type = GL_FLOAT;
+}
+
+void SpectrogramEditor::allocateSpectrogramTexture(int width, int height, DbFormat::Type format)
+{
+    // Immutable storage can't be resized, so a new size is a new texture
+    if (textureId != 0)
+        glDeleteTextures(1, &textureId);
+
+    // A texture row per view column: the display's frequency rows run along
+    // s, and the ring of columns wraps along t
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    GLenum internalFormat, type;
+    getTexturePixelFormat(format, internalFormat, type);
+
+    // glTexStorage2D is GL 4.2 (or ARB_texture_storage); without it the
+    // storage is specified once the old way and only ever sub-updated
+    if (glTexStorage2D != nullptr)
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat), width, height, 0, GL_RED, type, nullptr);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    textureAllocWidth = width;
+    textureAllocHeight = height;
+    textureAllocFormat = format;
+}
+
+void SpectrogramEditor::uploadTextures()
+{
+    // Rows the message thread has drawn, in runs of consecutive rows. A new
+    // size or format comes with a complete set of rows, so the new texture
+    // is filled. Rows are padded to 4 bytes, the default unpack alignment.
+    spectrogramStream.upload([this](const TextureStream::Region& region, const void* pixels)
+    {
+        const auto format = static_cast<DbFormat::Type>(region.format);
+
+        if (region.imageWidth != textureAllocWidth || region.imageHeight != textureAllocHeight
+            || format != textureAllocFormat)
+            allocateSpectrogramTexture(region.imageWidth, region.imageHeight, format);
+
+        GLenum internalFormat, type;
+        getTexturePixelFormat(format, internalFormat, type);
+
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height,
+                        GL_RED, type, pixels);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    });
+
+    // Nebula sends its whole image each tick
+    nebulaStream.upload([this](const TextureStream::Region& region, const void* pixels)
+    {
+        glBindTexture(GL_TEXTURE_2D, nebulaTexId);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height,
+                        GL_RGB, GL_FLOAT, pixels);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    });
 }
 
 void SpectrogramEditor::createBloomResources(int width, int height)
@@ -456,9 +530,6 @@ void SpectrogramEditor::renderWithBloom(int vpX, int vpY, int vpW, int vpH)
     glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
     glViewport(0, 0, vpW, vpH);
 
-    const auto& analyser = processorRef.getAnalyser();
-    const float nyquist = static_cast<float>(analyser.getSampleRate() / 2.0);
-
     if (nebulaMode && nebulaShader)
     {
         // Render nebula to scene FBO using nebula shader
@@ -480,14 +551,11 @@ void SpectrogramEditor::renderWithBloom(int vpX, int vpY, int vpW, int vpH)
     shader->setUniform("scrollOffset", textureWidth > 0
         ? static_cast<float>(writePosition) / static_cast<float>(textureWidth)
         : 0.0f);
+    shader->setUniform("textureDbScale", DbFormat::getShaderScale(textureAllocFormat));
+    shader->setUniform("textureDbOffset", DbFormat::getShaderOffset(textureAllocFormat));
     shader->setUniform("colourMapType", static_cast<GLint>(colourMapType));
     shader->setUniform("dbFloor", dbFloor);
     shader->setUniform("dbCeiling", dbCeiling);
-    shader->setUniform("useLogScale", logScale ? 1 : 0);
-    shader->setUniform("logMinFreq", static_cast<float>(minLogFreq));
-    shader->setUniform("nyquist", nyquist);
-    shader->setUniform("zoomMinFreq", zoomMinFreq);
-    shader->setUniform("zoomMaxFreq", std::min(zoomMaxFreq, nyquist));
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, textureId);
@@ -584,28 +652,8 @@ void SpectrogramEditor::renderOpenGL()
     glScissor(vpX, vpY, vpW, vpH);
     glViewport(vpX, vpY, vpW, vpH);
 
-    // Upload spectrogram texture data if needed
-    if (textureNeedsUpload.load(std::memory_order_acquire) && textureWidth > 0 && textureNumBins > 0)
-    {
-        // Swap front buffer from the back buffer that was written by message thread
-        textureDataFront = textureDataBack;
-
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F,
-                     textureWidth, textureNumBins, 0,
-                     GL_RED, GL_FLOAT, textureDataFront.data());
-        glBindTexture(GL_TEXTURE_2D, 0);
-        textureNeedsUpload.store(false, std::memory_order_release);
-    }
-
-    // Upload nebula texture if in nebula mode
-    if (nebulaMode && !nebulaAccum.empty())
-    {
-        glBindTexture(GL_TEXTURE_2D, nebulaTexId);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, nebulaTexW, nebulaTexH,
-                        GL_RGB, GL_FLOAT, nebulaAccum.data());
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+    // Upload the spectrogram rows and Nebula image the message thread sent
+    uploadTextures();
 
     if (bloomEnabled && brightExtractShader && blurShader && compositeShader)
     {
@@ -627,22 +675,16 @@ void SpectrogramEditor::renderOpenGL()
     else
     {
         // Standard spectrogram render
-        const auto& analyser = processorRef.getAnalyser();
-        const float nyquist = static_cast<float>(analyser.getSampleRate() / 2.0);
-
         shader->use();
         shader->setUniform("magnitudeTexture", 0);
         shader->setUniform("scrollOffset", textureWidth > 0
             ? static_cast<float>(writePosition) / static_cast<float>(textureWidth)
             : 0.0f);
+        shader->setUniform("textureDbScale", DbFormat::getShaderScale(textureAllocFormat));
+        shader->setUniform("textureDbOffset", DbFormat::getShaderOffset(textureAllocFormat));
         shader->setUniform("colourMapType", static_cast<GLint>(colourMapType));
         shader->setUniform("dbFloor", dbFloor);
         shader->setUniform("dbCeiling", dbCeiling);
-        shader->setUniform("useLogScale", logScale ? 1 : 0);
-        shader->setUniform("logMinFreq", static_cast<float>(minLogFreq));
-        shader->setUniform("nyquist", nyquist);
-        shader->setUniform("zoomMinFreq", zoomMinFreq);
-        shader->setUniform("zoomMaxFreq", std::min(zoomMaxFreq, nyquist));
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, textureId);
@@ -659,6 +701,8 @@ void SpectrogramEditor::renderOpenGL()
 
 void SpectrogramEditor::openGLContextClosing()
 {
+    spectrogramStream.release();
+    nebulaStream.release();
     destroyBloomResources();
 
     if (nebulaTexId != 0) { glDeleteTextures(1, &nebulaTexId); nebulaTexId = 0; }
@@ -694,18 +738,6 @@ float SpectrogramEditor::freqToNorm(double freq) const
     }
 }
 
-double SpectrogramEditor::normToFreq(float norm) const
-{
-    const double lo = static_cast<double>(zoomMinFreq);
-    const double hi = static_cast<double>(zoomMaxFreq);
-    norm = std::clamp(norm, 0.0f, 1.0f);
-
-    if (logScale)
-        return lo * std::pow(hi / lo, static_cast<double>(norm));
-    else
-        return lo + (hi - lo) * static_cast<double>(norm);
-}
-
 juce::Rectangle<int> SpectrogramEditor::getSpectrogramArea() const
 {
     return getLocalBounds().withTrimmedLeft(leftMargin)
@@ -726,10 +758,8 @@ void SpectrogramEditor::buildControls()
         addAndMakeVisible(label);
     };
 
-    fftSizeBox.addItem("1024",  1);
-    fftSizeBox.addItem("2048",  2);
-    fftSizeBox.addItem("4096",  3);
-    fftSizeBox.addItem("8192",  4);
+    for (const auto& choice : SpectrogramProcessor::fftSizeChoices)
+        fftSizeBox.addItem(juce::String(choice.size), choice.id);
     fftSizeBox.setSelectedId(3);
     fftSizeBox.onChange = [this] { onFFTSizeChanged(); };
     addAndMakeVisible(fftSizeBox);
@@ -742,8 +772,8 @@ void SpectrogramEditor::buildControls()
     addAndMakeVisible(overlapBox);
     setupLabel(overlapLabel);
 
-    windowBox.addItem("Hann",           1);
-    windowBox.addItem("Blackman-Harris", 2);
+    for (const auto& choice : SpectrogramProcessor::windowChoices)
+        windowBox.addItem(WindowBank::getName(choice.type), choice.id);
     windowBox.setSelectedId(1);
     windowBox.onChange = [this] { onWindowChanged(); };
     addAndMakeVisible(windowBox);
@@ -783,9 +813,30 @@ void SpectrogramEditor::buildControls()
     {
         frozen = freezeButton.getToggleState();
         freezeButton.setButtonText(frozen ? "Resume" : "Freeze");
+
+        // Frozen, the view stays where it is but can still be scrolled;
+        // resuming goes back to the newest frames
+        if (frozen)
+            scrollTo(followLive ? processorRef.getHistory().getInfo().end : viewEndFrame);
+        else
+            followLive = true;
     };
     addAndMakeVisible(freezeButton);
 
+    aggregateButton.setClickingTogglesState(true);
+    aggregateButton.onClick = [this]
+    {
+        aggregateMean = aggregateButton.getToggleState();
+        aggregateButton.setButtonText(aggregateMean ? "Mean" : "Max");
+        processorRef.settings.aggregateMean = aggregateMean;
+
+        // Rows combine bins wherever several share one, so the whole view
+        // and the curves change
+        viewChanged = true;
+        repaint();
+    };
+    addAndMakeVisible(aggregateButton);
+
     // Row 2: Mode
     modeBox.addItem("Spectrogram", 1);
     modeBox.addItem("Nebula", 2);
@@ -803,6 +854,32 @@ void SpectrogramEditor::buildControls()
     addAndMakeVisible(modeBox);
     setupLabel(modeLabel);
 
+    // Engine: full-band FFT, band-limited analysis of the zoom range, the
+    // log-spaced multi-resolution bank, the sliding DFT or the reassigned FFT
+    for (const auto& choice : SpectrogramProcessor::engineChoices)
+        engineBox.addItem(SpectralAnalyser::getEngineName(choice.engine), choice.id);
+    engineBox.setSelectedId(1);
+    engineBox.onChange = [this] { onEngineChanged(); };
+    addAndMakeVisible(engineBox);
+    setupLabel(engineLabel);
+
+    // Sliding-DFT hop, in samples or milliseconds
+    for (const auto& choice : SpectrogramProcessor::slidingHopChoices)
+        hopBox.addItem(choice.name, choice.id);
+    hopBox.setSelectedId(3);
+    hopBox.onChange = [this] { onSlidingHopChanged(); };
+    addAndMakeVisible(hopBox);
+    setupLabel(hopLabel);
+
+    // How the history stores frames: narrower formats hold the same time in
+    // less memory and upload less, for some precision
+    for (const auto& choice : SpectrogramProcessor::historyFormatChoices)
+        historyFormatBox.addItem(choice.name, choice.id);
+    historyFormatBox.setSelectedId(1);
+    historyFormatBox.onChange = [this] { onHistoryFormatChanged(); };
+    addAndMakeVisible(historyFormatBox);
+    setupLabel(historyFormatLabel);
+
     // Bloom toggle + intensity
     bloomButton.setClickingTogglesState(true);
     bloomButton.onClick = [this]
@@ -899,6 +976,7 @@ void SpectrogramEditor::buildControls()
             zoomMinSlider.setValue(zoomMinFreq, juce::dontSendNotification);
         }
         processorRef.settings.zoomMinFreq = zoomMinFreq;
+        processorRef.setZoomBand(zoomMinFreq, zoomMaxFreq);
         repaint();
     };
     addAndMakeVisible(zoomMinSlider);
@@ -918,6 +996,7 @@ void SpectrogramEditor::buildControls()
             zoomMaxSlider.setValue(zoomMaxFreq, juce::dontSendNotification);
         }
         processorRef.settings.zoomMaxFreq = zoomMaxFreq;
+        processorRef.setZoomBand(zoomMinFreq, zoomMaxFreq);
         repaint();
     };
     addAndMakeVisible(zoomMaxSlider);
@@ -932,42 +1011,53 @@ void SpectrogramEditor::updateModeVisibility()
     rtaButton.setVisible(!nebulaMode);
     colourMapBox.setVisible(!nebulaMode);
     colourLabel.setVisible(!nebulaMode);
+
+    // Nebula needs the stereo outputs, which only the FFT produces
+    engineBox.setEnabled(!nebulaMode);
+    hopBox.setEnabled(!nebulaMode && SpectrogramProcessor::getEngineForId(engineBox.getSelectedId())
+                                         == SpectralAnalyser::Engine::slidingDFT);
 }
 
 void SpectrogramEditor::onFFTSizeChanged()
 {
-    auto& analyser = processorRef.getAnalyser();
-    SpectralAnalyser::FFTOrder order;
-    switch (fftSizeBox.getSelectedId())
-    {
-        case 1:  order = SpectralAnalyser::FFTOrder::order1024; break;
-        case 2:  order = SpectralAnalyser::FFTOrder::order2048; break;
-        case 4:  order = SpectralAnalyser::FFTOrder::order8192; break;
-        default: order = SpectralAnalyser::FFTOrder::order4096; break;
-    }
-    analyser.prepare(analyser.getSampleRate(), order);
+    processorRef.setFFTSize(SpectrogramProcessor::getFFTSizeForId(fftSizeBox.getSelectedId()));
     processorRef.settings.fftSizeId = fftSizeBox.getSelectedId();
-    textureDataBack.clear();
-    textureDataFront.clear();
-    textureWidth = 0;
-    writePosition = 0;
-    peakHoldData.clear();
 }
 
 void SpectrogramEditor::onOverlapChanged()
 {
-    processorRef.getAnalyser().setOverlap(overlapBox.getSelectedId() == 2 ? 0.75f : 0.5f);
+    processorRef.setOverlap(overlapBox.getSelectedId() == 2 ? 0.75f : 0.5f);
     processorRef.settings.overlapId = overlapBox.getSelectedId();
 }
 
 void SpectrogramEditor::onWindowChanged()
 {
-    processorRef.getAnalyser().setWindowType(windowBox.getSelectedId() == 2
-        ? SpectralAnalyser::WindowType::blackmanHarris
-        : SpectralAnalyser::WindowType::hann);
+    processorRef.setWindowType(SpectrogramProcessor::getWindowTypeForId(windowBox.getSelectedId()));
     processorRef.settings.windowId = windowBox.getSelectedId();
 }
 
+void SpectrogramEditor::onEngineChanged()
+{
+    // The texture follows the new bin layout once its first frame arrives
+    processorRef.setEngine(SpectrogramProcessor::getEngineForId(engineBox.getSelectedId()));
+    processorRef.settings.engineId = engineBox.getSelectedId();
+    updateModeVisibility();
+}
+
+void SpectrogramEditor::onSlidingHopChanged()
+{
+    const double sampleRate = processorRef.getAnalyser().getSampleRate();
+    processorRef.setSlidingHop(SpectrogramProcessor::getSlidingHopForId(hopBox.getSelectedId(), sampleRate));
+    processorRef.settings.slidingHopId = hopBox.getSelectedId();
+}
+
+void SpectrogramEditor::onHistoryFormatChanged()
+{
+    // The history restarts, and the view with it
+    processorRef.setHistoryFormat(SpectrogramProcessor::getHistoryFormatForId(historyFormatBox.getSelectedId()));
+    processorRef.settings.historyFormatId = historyFormatBox.getSelectedId();
+}
+
 // ── Nebula texture update ───────────────────────────────────────────────
 
 void SpectrogramEditor::updateNebulaTexture()
@@ -984,13 +1074,17 @@ void SpectrogramEditor::updateNebulaTexture()
     for (auto& v : nebulaAccum)
         v *= decay;
 
-    while (stereoAnalyser.pullNextFrame(stereoFrame))
+    SpectralAnalyser::FrameView frame;
+
+    while (stereoAnalyser.acquireStereoFrame(frame))
     {
-        const int frameBins = static_cast<int>(stereoFrame.magnitudeDb.size());
+        const int frameBins = frame.layout.numBins;
+        nebulaRowMap.update(frame.layout, nebulaTexH, zoomMinFreq, zoomMaxFreq, logScale);
+
         for (int bin = 0; bin < frameBins; ++bin)
         {
-            float db = stereoFrame.magnitudeDb[static_cast<size_t>(bin)];
-            float pan = stereoFrame.pan[static_cast<size_t>(bin)];
+            float db = frame.stereoDb[bin];
+            float pan = frame.pan[bin];
 
             // Map dB to brightness
             float t = (db - dbFloor) / (dbCeiling - dbFloor);
@@ -998,8 +1092,7 @@ void SpectrogramEditor::updateNebulaTexture()
             t = std::clamp(t, 0.0f, 1.0f);
 
             // Map frequency to Y position
-            float freq = static_cast<float>(bin) / static_cast<float>(frameBins - 1) * static_cast<float>(nyquist);
-            float yNorm = freqToNorm(freq);
+            float yNorm = nebulaRowMap.getBinNorm(bin);
             int yIdx = std::clamp(static_cast<int>(yNorm * (nebulaTexH - 1)), 0, nebulaTexH - 1);
 
             // Map pan (-1..+1) to X position (0..nebulaTexW-1)
@@ -1049,92 +1142,295 @@ void SpectrogramEditor::updateNebulaTexture()
                 }
             }
         }
+
+        stereoAnalyser.releaseStereoFrame();
     }
 
     // Clamp to prevent overflow
     for (auto& v : nebulaAccum)
         v = std::min(v, 1.5f);
+
+    // Skipped if the GPU hasn't finished with earlier images; the next tick
+    // sends a newer one
+    const TextureStream::Region region { nebulaTexW, nebulaTexH, 0, 0, nebulaTexW, nebulaTexH };
+    const size_t numBytes = nebulaAccum.size() * sizeof(float);
+
+    if (auto* dest = nebulaStream.allocate(region, numBytes))
+    {
+        std::memcpy(dest, nebulaAccum.data(), numBytes);
+        nebulaStream.publish();
+    }
 }
 
 // ── Timer / frame processing ────────────────────────────────────────────
 
 void SpectrogramEditor::timerCallback()
 {
-    if (frozen)
-        return;
-
     double now = juce::Time::getMillisecondCounterHiRes() / 1000.0;
     double dt = now - lastTimerTime;
     lastTimerTime = now;
 
     if (nebulaMode)
     {
+        if (frozen)
+            return;
+
         updateNebulaTexture();
         glContext.triggerRepaint();
         repaint();
         return;
     }
 
-    auto& analyser = processorRef.getAnalyser();
-    const int numBins = analyser.getNumBins();
+    const auto& history = processorRef.getHistory();
+    const auto info = history.getInfo();
+    const auto& layout = info.layout;
+    const int numBins = layout.numBins;
     const auto area = getSpectrogramArea();
     const int w = area.getWidth();
+    const int h = area.getHeight();
 
-    if (w <= 0 || numBins <= 0)
+    if (w <= 0 || h <= 0 || numBins <= 1)
         return;
 
-    // Resize texture data if needed
-    if (textureWidth != w || textureNumBins != numBins)
+    // A new size, or a restarted history, redraws the view from the history.
+    // A new layout also invalidates the old curves.
+    if (textureWidth != w || historyGeneration != info.generation)
     {
         textureWidth = w;
-        textureNumBins = numBins;
-        textureDataBack.assign(static_cast<size_t>(w) * static_cast<size_t>(numBins), -100.0f);
-        textureDataFront.assign(static_cast<size_t>(w) * static_cast<size_t>(numBins), -100.0f);
-        writePosition = 0;
-    }
+        columnScratch.resize(static_cast<size_t>(numBins));
+        frameScratch.resize(static_cast<size_t>(numBins));
 
-    if (frameBuffer.size() != static_cast<size_t>(numBins))
-        frameBuffer.resize(static_cast<size_t>(numBins));
+        if (textureLayout != layout)
+        {
+            lastFrame.clear();
+            peakHoldData.clear();
+        }
 
-    bool gotNewData = false;
+        textureLayout = layout;
 
-    while (analyser.pullNextFrame(frameBuffer.data(), numBins))
-    {
-        for (int bin = 0; bin < numBins; ++bin)
+        // Frame numbers from before a restart mean nothing now
+        if (historyGeneration != info.generation)
         {
-            textureDataBack[static_cast<size_t>(bin) * static_cast<size_t>(textureWidth)
-                        + static_cast<size_t>(writePosition)] = frameBuffer[static_cast<size_t>(bin)];
+            followLive = !frozen;
+            viewEndFrame = info.end;
+            lastFrameIndex = -1;
         }
 
-        lastFrame.assign(frameBuffer.begin(), frameBuffer.end());
-        writePosition = (writePosition + 1) % textureWidth;
-        gotNewData = true;
+        historyGeneration = info.generation;
+        viewChanged = true;
+    }
+
+    // The texture's rows are the display's: a new height, zoom range or
+    // scale redraws the view through new tables
+    if (rowMap.update(layout, h, zoomMinFreq, zoomMaxFreq, logScale))
+    {
+        rowScratch.resize(static_cast<size_t>(h));
+        viewChanged = true;
+    }
+
+    // A new GL context has a new, empty texture
+    const auto streamGeneration = spectrogramStream.getGeneration();
+
+    if (streamGeneration != spectrogramStreamGeneration)
+    {
+        spectrogramStreamGeneration = streamGeneration;
+        viewChanged = true;
+    }
+
+    // Scrolled back, the view keeps at least a frame of what the history
+    // still holds
+    if (!followLive)
+        viewEndFrame = juce::jlimit(juce::jmin(info.end, info.getOldest() + 1), info.end, viewEndFrame);
+
+    const int64_t endFrame = followLive ? info.end : viewEndFrame;
+    const int64_t endColumn = (endFrame + framesPerColumn - 1) / framesPerColumn;
+    const int64_t beginColumn = endColumn - w;
+
+    if (viewChanged)
+    {
+        drawnBegin = drawnEnd = beginColumn;
+        viewChanged = false;
+    }
+
+    // Columns drawn before and still in view stay as they are; only those
+    // scrolled into view are drawn, and the newest again as more of its
+    // frames arrive
+    drawnBegin = juce::jlimit(beginColumn, endColumn, drawnBegin);
+    drawnEnd = juce::jlimit(drawnBegin, endColumn, drawnEnd);
+
+    if (hasPartialColumn && partialColumn >= drawnBegin && partialColumn < drawnEnd
+        && partialColumnEnd != info.end)
+        drawnEnd = partialColumn;
+
+    // Drawing stops where the GPU hasn't caught up with the staging memory;
+    // the rest follow next tick
+    const auto drawnBefore = drawnEnd - drawnBegin;
+
+    while (drawnEnd < endColumn && drawColumn(info, drawnEnd))
+        ++drawnEnd;
+
+    while (drawnBegin > beginColumn && drawColumn(info, drawnBegin - 1))
+        --drawnBegin;
+
+    spectrogramStream.publish();
+
+    const bool gotNewColumns = drawnEnd - drawnBegin != drawnBefore;
+
+    hasPartialColumn = drawnEnd == endColumn && endColumn * framesPerColumn > info.end;
+    partialColumn = endColumn - 1;
+    partialColumnEnd = info.end;
+    viewEndColumn = endColumn;
+    writePosition = static_cast<int>(((endColumn % w) + w) % w);
+
+    // Only the newest frame is kept for RTA / peak hold, scrolled back or not
+    bool gotNewFrame = false;
+
+    if (!frozen && info.end > 0 && info.end - 1 != lastFrameIndex)
+    {
+        history.read(info, info.end - 1, info.end, [&](int64_t index, const uint8_t* frame)
+        {
+            lastFrame.resize(static_cast<size_t>(numBins));
+            DbFormat::decode(info.format, frame, lastFrame.data(), numBins);
+            lastFrameIndex = index;
+            gotNewFrame = true;
+        });
     }
 
     // Update peak hold data
-    if (peakHoldEnabled && !lastFrame.empty())
+    if (peakHoldEnabled && !frozen && !lastFrame.empty())
     {
         if (peakHoldData.size() != lastFrame.size())
             peakHoldData.assign(lastFrame.size(), -100.0f);
 
         float decayAmount = peakDecayRate * static_cast<float>(dt);
-        for (size_t i = 0; i < peakHoldData.size(); ++i)
+        DspKernels::maxWithDecay(peakHoldData.data(), lastFrame.data(),
+                                 static_cast<int>(peakHoldData.size()), decayAmount, DspKernels::floorDb);
+    }
+
+    // The GL thread only releases staging memory when it renders, so columns
+    // left undrawn for want of it need a render too, or a frozen or stopped
+    // view would stay half drawn
+    const bool drawingIncomplete = drawnEnd < endColumn || drawnBegin > beginColumn;
+
+    if (gotNewColumns || drawingIncomplete)
+        glContext.triggerRepaint();
+
+    if (gotNewColumns || gotNewFrame)
+        repaint();
+}
+
+bool SpectrogramEditor::drawColumn(const SpectrogramHistory::Info& info, int64_t column)
+{
+    const int numBins = info.layout.numBins;
+    const int numRows = rowMap.getNumRows();
+    const auto ringRow = static_cast<int>(((column % textureWidth) + textureWidth) % textureWidth);
+    const TextureStream::Region region { numRows, textureWidth, 0, ringRow, numRows, 1, static_cast<int>(info.format) };
+    const auto numBytes = static_cast<size_t>(numRows) * static_cast<size_t>(DbFormat::getBytesPerValue(info.format));
+
+    auto* dest = spectrogramStream.allocate(region, numBytes);
+
+    if (dest == nullptr)
+        return false;
+
+    // A single frame is resampled onto the rows as it's read; several are
+    // combined bin by bin in columnScratch first, as their max in dB or their
+    // mean in power, like the bins of a row. The rows are then encoded into
+    // the staging memory, which isn't for reading back.
+    const auto aggregate = getRowAggregate();
+    float* accum = columnScratch.data();
+    int numFrames = 0;
+
+    const int64_t first = column * framesPerColumn;
+    const int64_t last = juce::jmin(first + framesPerColumn, info.end);
+
+    processorRef.getHistory().read(info, first, last, [&](int64_t, const uint8_t* frame)
+    {
+        // Floats can be read where they are
+        const float* frameDb = reinterpret_cast<const float*>(frame);
+
+        if (info.format != DbFormat::Type::float32)
         {
-            if (lastFrame[i] > peakHoldData[i])
-                peakHoldData[i] = lastFrame[i];
-            else
-                peakHoldData[i] -= decayAmount;
+            DbFormat::decode(info.format, frame, frameScratch.data(), numBins);
+            frameDb = frameScratch.data();
+        }
 
-            peakHoldData[i] = std::max(peakHoldData[i], -100.0f);
+        if (framesPerColumn == 1)
+        {
+            rowMap.apply(frameDb, rowScratch.data(), aggregate);
+        }
+        else if (aggregateMean)
+        {
+            // frameScratch is either free or holds frameDb, which is done with
+            // once it's converted
+            float* power = numFrames == 0 ? accum : frameScratch.data();
+            DspKernels::dbToPower(frameDb, power, numBins);
+
+            if (numFrames > 0)
+                for (int i = 0; i < numBins; ++i)
+                    accum[i] += power[i];
+        }
+        else if (numFrames == 0)
+        {
+            std::copy(frameDb, frameDb + numBins, accum);
+        }
+        else
+        {
+            DspKernels::maxWithDecay(accum, frameDb, numBins, 0.0f, DspKernels::floorDb);
         }
-    }
 
-    if (gotNewData)
+        ++numFrames;
+    });
+
+    // Before the oldest frame held, or before the first, the view is empty
+    if (numFrames == 0)
     {
-        textureNeedsUpload.store(true, std::memory_order_release);
-        glContext.triggerRepaint();
-        repaint();
+        std::fill(rowScratch.begin(), rowScratch.end(), -100.0f);
+    }
+    else if (framesPerColumn > 1)
+    {
+        // The mean power, back to dB, with the division folded into the offset
+        if (aggregateMean)
+            DspKernels::powerToDb(accum, accum, numBins, -10.0f * std::log10(static_cast<float>(numFrames)));
+
+        rowMap.apply(accum, rowScratch.data(), aggregate);
     }
+
+    DbFormat::encode(info.format, rowScratch.data(), dest, numRows);
+    return true;
+}
+
+void SpectrogramEditor::scrollTo(int64_t endFrame)
+{
+    const auto info = processorRef.getHistory().getInfo();
+
+    viewEndFrame = juce::jlimit(juce::jmin(info.end, info.getOldest() + 1), info.end, endFrame);
+    followLive = !frozen && viewEndFrame >= info.end;
+    repaint();
+}
+
+void SpectrogramEditor::setFramesPerColumn(int newFramesPerColumn)
+{
+    const auto info = processorRef.getHistory().getInfo();
+    const int w = juce::jmax(1, getSpectrogramArea().getWidth());
+
+    // Zoomed out no further than the whole history across the view
+    int maxFramesPerColumn = 1;
+
+    while (maxFramesPerColumn < maxZoomOut && static_cast<int64_t>(maxFramesPerColumn) * w < info.capacity)
+        maxFramesPerColumn *= 2;
+
+    newFramesPerColumn = juce::jlimit(1, maxFramesPerColumn, newFramesPerColumn);
+
+    if (newFramesPerColumn == framesPerColumn)
+        return;
+
+    // The right edge stays put
+    if (!followLive)
+        viewEndFrame = juce::jmin(info.end, viewEndColumn * framesPerColumn);
+
+    framesPerColumn = newFramesPerColumn;
+    viewChanged = true;
+    repaint();
 }
 
 // ── Mouse interaction ───────────────────────────────────────────────────
@@ -1152,30 +1448,78 @@ void SpectrogramEditor::mouseExit(const juce::MouseEvent&)
     repaint();
 }
 
+void SpectrogramEditor::mouseDown(const juce::MouseEvent& e)
+{
+    const auto info = processorRef.getHistory().getInfo();
+    dragStartX = e.position.x;
+    dragStartEndFrame = followLive ? info.end : viewEndFrame;
+}
+
+void SpectrogramEditor::mouseDrag(const juce::MouseEvent& e)
+{
+    mousePos = e.getPosition();
+
+    if (nebulaMode)
+        return;
+
+    // The image follows the mouse: dragging right brings older frames in
+    const auto columns = static_cast<int64_t>(std::lround(e.position.x - dragStartX));
+    scrollTo(dragStartEndFrame - columns * framesPerColumn);
+}
+
+void SpectrogramEditor::mouseDoubleClick(const juce::MouseEvent&)
+{
+    if (!nebulaMode)
+        scrollTo(processorRef.getHistory().getInfo().end);
+}
+
+void SpectrogramEditor::mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
+{
+    if (nebulaMode || !getSpectrogramArea().contains(e.getPosition()))
+        return;
+
+    // Cmd/Ctrl + wheel zooms in time, a notch at a time; otherwise the
+    // wheel scrolls, up or left into older frames
+    if (e.mods.isCommandDown() || e.mods.isCtrlDown())
+    {
+        if (wheel.deltaY != 0.0f)
+            setFramesPerColumn(wheel.deltaY < 0.0f ? framesPerColumn * 2 : framesPerColumn / 2);
+
+        return;
+    }
+
+    const float delta = wheel.deltaX != 0.0f ? -wheel.deltaX : wheel.deltaY;
+    const auto columns = static_cast<int64_t>(std::lround(delta * wheelColumnsPerUnit));
+
+    if (columns == 0)
+        return;
+
+    const auto info = processorRef.getHistory().getInfo();
+    scrollTo((followLive ? info.end : viewEndFrame) - columns * framesPerColumn);
+}
+
 // ── Drawing helpers ─────────────────────────────────────────────────────
 
 void SpectrogramEditor::drawMagnitudeCurve(juce::Graphics& g, juce::Rectangle<int> area,
                                            const std::vector<float>& data, juce::Colour colour,
                                            bool filled)
 {
-    if (data.empty()) return;
+    // Resampled onto the display rows through the spectrogram's tables
+    if (data.size() != static_cast<size_t>(rowMap.getLayout().numBins)
+        || rowMap.getNumRows() != area.getHeight())
+        return;
+
+    curveRows.resize(static_cast<size_t>(rowMap.getNumRows()));
+    rowMap.apply(data.data(), curveRows.data(), getRowAggregate());
 
-    const int numBins = static_cast<int>(data.size());
-    const double nyquist = processorRef.getAnalyser().getSampleRate() / 2.0;
     const float areaW = static_cast<float>(area.getWidth());
-    const float areaH = static_cast<float>(area.getHeight());
 
     juce::Path path;
     bool started = false;
 
     for (int y = 0; y < area.getHeight(); ++y)
     {
-        float norm = 1.0f - static_cast<float>(y) / areaH;
-        double freq = normToFreq(norm);
-        float binFloat = static_cast<float>(freq / nyquist) * static_cast<float>(numBins - 1);
-        int bin = std::clamp(static_cast<int>(binFloat), 0, numBins - 1);
-
-        float db = data[static_cast<size_t>(bin)];
+        float db = curveRows[static_cast<size_t>(area.getHeight() - 1 - y)];
         float t = (db - dbFloor) / (dbCeiling - dbFloor);
         t = std::clamp(t, 0.0f, 1.0f);
 
@@ -1320,27 +1664,39 @@ void SpectrogramEditor::drawFrequencyAxis(juce::Graphics& g, juce::Rectangle<int
 
 void SpectrogramEditor::drawTimeAxis(juce::Graphics& g, juce::Rectangle<int> area)
 {
-    auto& analyser = processorRef.getAnalyser();
-    const double sampleRate = analyser.getSampleRate();
-    const int fftSize = analyser.getFFTSize();
-    if (sampleRate <= 0.0 || fftSize <= 0) return;
+    const auto info = processorRef.getHistory().getInfo();
+    if (info.sampleRate <= 0.0 || info.hop <= 0 || info.generation != historyGeneration) return;
 
-    const double hopSamples = fftSize * 0.5;
-    const double secondsPerColumn = hopSamples / sampleRate;
+    const double secondsPerFrame = info.hop / info.sampleRate;
+    const double secondsPerColumn = framesPerColumn * secondsPerFrame;
     const double totalSeconds = area.getWidth() * secondsPerColumn;
 
+    // How far the right edge is behind the newest frame
+    const int64_t rightEdgeFrame = juce::jmin(info.end, viewEndColumn * framesPerColumn);
+    const double rightEdgeSeconds = static_cast<double>(info.end - rightEdgeFrame) * secondsPerFrame;
+
     g.setFont(juce::FontOptions(11.0f));
 
-    double tickInterval = 0.5;
-    if (totalSeconds > 20.0) tickInterval = 5.0;
-    else if (totalSeconds > 10.0) tickInterval = 2.0;
-    else if (totalSeconds > 5.0) tickInterval = 1.0;
+    // At most about 8 ticks across
+    constexpr double tickIntervals[] = { 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0, 60.0 };
+    double tickInterval = tickIntervals[juce::numElementsInArray(tickIntervals) - 1];
 
+    for (double interval : tickIntervals)
+    {
+        if (totalSeconds / interval <= 8.0)
+        {
+            tickInterval = interval;
+            break;
+        }
+    }
+
+    const int decimals = tickInterval < 0.1 ? 2 : (tickInterval < 1.0 ? 1 : 0);
     const int labelY = area.getBottom() + 3;
 
-    for (double t = 0.0; t < totalSeconds; t += tickInterval)
+    for (double t = std::ceil(rightEdgeSeconds / tickInterval - 1.0e-6) * tickInterval;
+         t < rightEdgeSeconds + totalSeconds; t += tickInterval)
     {
-        const int x = area.getRight() - static_cast<int>(t / secondsPerColumn);
+        const int x = area.getRight() - static_cast<int>((t - rightEdgeSeconds) / secondsPerColumn);
         if (x < area.getX()) break;
 
         g.setColour(juce::Colours::grey.withAlpha(0.3f));
@@ -1348,7 +1704,7 @@ void SpectrogramEditor::drawTimeAxis(juce::Graphics& g, juce::Rectangle<int> are
                            static_cast<float>(area.getBottom()));
 
         g.setColour(CustomLookAndFeel::textSecondary);
-        juce::String label = (t == 0.0) ? "now" : ("-" + juce::String(t, 1) + "s");
+        juce::String label = (t < 0.5 * tickInterval) ? "now" : ("-" + juce::String(t, decimals) + "s");
         g.drawText(label, x - 25, labelY, 50, 16, juce::Justification::centred);
     }
 }
@@ -1390,16 +1746,14 @@ void SpectrogramEditor::drawHoverInfo(juce::Graphics& g, juce::Rectangle<int> ar
 {
     if (!area.contains(mousePos) || lastFrame.empty()) return;
 
-    const double nyquist = processorRef.getAnalyser().getSampleRate() / 2.0;
-    const int numBins = static_cast<int>(lastFrame.size());
-
-    const float norm = static_cast<float>(area.getBottom() - mousePos.y)
-                     / static_cast<float>(area.getHeight());
-    const double freq = normToFreq(std::clamp(norm, 0.0f, 1.0f));
+    if (lastFrame.size() != static_cast<size_t>(rowMap.getLayout().numBins)
+        || rowMap.getNumRows() != area.getHeight())
+        return;
 
-    const float binFloat = static_cast<float>(freq / nyquist) * static_cast<float>(numBins - 1);
-    const int bin = std::clamp(static_cast<int>(binFloat), 0, numBins - 1);
-    const float db = lastFrame[static_cast<size_t>(bin)];
+    // The row under the mouse, as the spectrogram shows it
+    const int row = area.getBottom() - 1 - mousePos.y;
+    const double freq = rowMap.getRowHz(row);
+    const float db = rowMap.getRow(lastFrame.data(), row, getRowAggregate());
 
     juce::String freqStr = (freq >= 1000.0)
         ? juce::String(freq / 1000.0, 2) + " kHz"
@@ -1433,12 +1787,6 @@ void SpectrogramEditor::resized()
     processorRef.settings.editorWidth = getWidth();
     processorRef.settings.editorHeight = getHeight();
 
-    textureDataBack.clear();
-    textureDataFront.clear();
-    textureWidth = 0;
-    writePosition = 0;
-    peakHoldData.clear();
-
     auto area = getLocalBounds();
 
     // Two-row control bar
@@ -1468,6 +1816,8 @@ void SpectrogramEditor::resized()
     row1.removeFromLeft(gap);
     freezeButton.setBounds(row1.removeFromLeft(buttonW));
     row1.removeFromLeft(gap);
+    aggregateButton.setBounds(row1.removeFromLeft(buttonW));
+    row1.removeFromLeft(gap);
 
     dbFloorLabel.setBounds(row1.removeFromLeft(32));
     dbFloorSlider.setBounds(row1.removeFromLeft(sliderW));
@@ -1480,6 +1830,15 @@ void SpectrogramEditor::resized()
 
     modeLabel.setBounds(row2.removeFromLeft(34));
     modeBox.setBounds(row2.removeFromLeft(90));
+    row2.removeFromLeft(gap);
+    engineLabel.setBounds(row2.removeFromLeft(40));
+    engineBox.setBounds(row2.removeFromLeft(66));
+    row2.removeFromLeft(gap);
+    hopLabel.setBounds(row2.removeFromLeft(26));
+    hopBox.setBounds(row2.removeFromLeft(70));
+    row2.removeFromLeft(gap);
+    historyFormatLabel.setBounds(row2.removeFromLeft(34));
+    historyFormatBox.setBounds(row2.removeFromLeft(66));
     row2.removeFromLeft(gap + 4);
 
     bloomButton.setBounds(row2.removeFromLeft(buttonW));
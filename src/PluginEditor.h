@@ -4,7 +4,8 @@
 #include "PluginProcessor.h"
 #include "ColourMap.h"
 #include "CustomLookAndFeel.h"
-#include "StereoSpectralAnalyser.h"
+#include "TextureStream.h"
+#include "FrequencyRowMap.h"
 
 class SpectrogramEditor : public juce::AudioProcessorEditor,
                            private juce::Timer,
@@ -19,6 +20,10 @@ public:
 
     void mouseMove(const juce::MouseEvent& e) override;
     void mouseExit(const juce::MouseEvent& e) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseDoubleClick(const juce::MouseEvent& e) override;
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
 
     // OpenGLRenderer
     void newOpenGLContextCreated() override;
@@ -39,16 +44,28 @@ private:
     void drawGridLines(juce::Graphics& g, juce::Rectangle<int> area);
 
     float freqToNorm(double freq) const;
-    double normToFreq(float norm) const;
 
     juce::Rectangle<int> getSpectrogramArea() const;
 
+    // Time window helpers. drawColumn() returns false when there's no room
+    // to send the column yet.
+    bool drawColumn(const SpectrogramHistory::Info& info, int64_t column);
+    void scrollTo(int64_t endFrame);
+    void setFramesPerColumn(int newFramesPerColumn);
+
     void buildControls();
     void onFFTSizeChanged();
     void onOverlapChanged();
     void onWindowChanged();
+    void onEngineChanged();
+    void onSlidingHopChanged();
+    void onHistoryFormatChanged();
     void updateModeVisibility();
 
+    // Texture uploads, GL thread
+    void allocateSpectrogramTexture(int width, int height, DbFormat::Type format);
+    void uploadTextures();
+
     // Bloom FBO helpers
     void createBloomResources(int width, int height);
     void destroyBloomResources();
@@ -67,17 +84,68 @@ private:
     GLuint textureId = 0;
     bool glInitialised = false;
 
-    // Spectral texture data: [textureWidth * numBins] floats, circular columns
-    // Double-buffered: front for GL thread, back for message thread
-    std::vector<float> textureDataFront;
-    std::vector<float> textureDataBack;
+    // The spectrogram texture is time-major like the processor's history:
+    // each view column is one texture row of the display's frequency rows,
+    // resampled from the frame's bins through rowMap, and the texture rows
+    // are a ring with writePosition after the newest. The message thread
+    // draws them straight into spectrogramStream's staging memory and the GL
+    // thread uploads them from there; there's no CPU copy of the image.
     int textureWidth = 0;
-    int textureNumBins = 0;
     int writePosition = 0;
-    std::atomic<bool> textureNeedsUpload{false};
 
-    // Scratch buffer for pulling frames
-    std::vector<float> frameBuffer;
+    // Staging rings for the texture updates: two full views in floats at the
+    // largest editor size, and a few Nebula images in flight
+    TextureStream spectrogramStream{ 16 * 1024 * 1024, 4096 };
+    TextureStream nebulaStream{ 4 * nebulaImageBytes, 8 };
+    uint64_t spectrogramStreamGeneration = 0;
+    std::vector<float> columnScratch, frameScratch, rowScratch;
+
+    // The bins-to-rows tables for the spectrogram's frequency axis, shared
+    // with the RTA, peak-hold and hover overlays, and Nebula's for its image
+    FrequencyRowMap rowMap, nebulaRowMap;
+    std::vector<float> curveRows;
+
+    // The visible time window. Column c of the view aggregates history
+    // frames [c * framesPerColumn, (c + 1) * framesPerColumn) and lives in
+    // texture column c % textureWidth, so scrolling or zooming only draws
+    // the columns that come into view. Following live, the window's right
+    // edge is the newest frame; otherwise it stays at viewEndFrame.
+    int framesPerColumn = 1;
+    bool followLive = true;
+    int64_t viewEndFrame = 0;
+    bool aggregateMean = false;         // mean power of the frames and bins, not the max
+
+    FrequencyRowMap::Aggregate getRowAggregate() const noexcept
+    {
+        return aggregateMean ? FrequencyRowMap::Aggregate::meanPower : FrequencyRowMap::Aggregate::max;
+    }
+
+    // The history generation the texture was drawn from, the column after
+    // the view's right edge, and the view's columns already drawn. The
+    // newest may have been drawn before all its frames were in: the history
+    // ended at partialColumnEnd then.
+    uint64_t historyGeneration = 0;
+    int64_t viewEndColumn = 0;
+    int64_t drawnBegin = 0, drawnEnd = 0;
+    bool hasPartialColumn = false;
+    int64_t partialColumn = 0, partialColumnEnd = 0;
+    bool viewChanged = true;
+    int64_t lastFrameIndex = -1;
+
+    // Drag scrolling
+    float dragStartX = 0.0f;
+    int64_t dragStartEndFrame = 0;
+
+    // Where the bins of the frames drawn sit in frequency
+    BinLayout textureLayout;
+
+    // GL thread: the size and format the texture's storage was allocated
+    // with; rows are in the history's format, so the texture is too
+    int textureAllocWidth = 0;
+    int textureAllocHeight = 0;
+    DbFormat::Type textureAllocFormat = DbFormat::Type::float32;
+
+    // Copy of the newest frame, for RTA, peak hold and hover
     std::vector<float> lastFrame;
 
     // Display settings
@@ -121,7 +189,7 @@ private:
     std::vector<float> nebulaAccum;   // [nebulaTexW * nebulaTexH * 3] RGB
     static constexpr int nebulaTexW = 256;  // pan resolution
     static constexpr int nebulaTexH = 512;  // frequency resolution
-    StereoFrame stereoFrame;
+    static constexpr size_t nebulaImageBytes = static_cast<size_t>(nebulaTexW) * nebulaTexH * 3 * sizeof(float);
 
     // Hover state
     bool mouseInside = false;
@@ -134,6 +202,10 @@ private:
     static constexpr int topMargin = 10;
     static constexpr int controlBarHeight = 60;
 
+    // Scrolling and zooming
+    static constexpr int maxZoomOut = 1024;          // frames per column, at most
+    static constexpr float wheelColumnsPerUnit = 200.0f;
+
     // Row 1 controls: Analysis + Display
     juce::ComboBox fftSizeBox;
     juce::ComboBox overlapBox;
@@ -141,9 +213,13 @@ private:
     juce::ComboBox colourMapBox;
     juce::TextButton scaleButton{"Log"};
     juce::TextButton freezeButton{"Freeze"};
+    juce::TextButton aggregateButton{"Max"};
 
     // Row 2 controls: Mode + Effects + Range
     juce::ComboBox modeBox;
+    juce::ComboBox engineBox;
+    juce::ComboBox hopBox;
+    juce::ComboBox historyFormatBox;
     juce::TextButton bloomButton{"Bloom"};
     juce::TextButton peakButton{"Peak"};
     juce::TextButton rtaButton{"RTA"};
@@ -162,6 +238,9 @@ private:
     juce::Label dbFloorLabel{{}, "Floor"};
     juce::Label dbCeilLabel{{}, "Ceil"};
     juce::Label modeLabel{{}, "Mode"};
+    juce::Label engineLabel{{}, "Engine"};
+    juce::Label hopLabel{{}, "Hop"};
+    juce::Label historyFormatLabel{{}, "Store"};
     juce::Label zoomMinLabel{{}, "Lo"};
     juce::Label zoomMaxLabel{{}, "Hi"};
 
@@ -1,16 +1,19 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "DspKernels.h"
 
 SpectrogramProcessor::SpectrogramProcessor()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
+    // Bind the DSP kernels now rather than on the audio thread's first block
+    DspKernels::get();
 }
 
 SpectrogramProcessor::~SpectrogramProcessor()
 {
-    stopTimer();
+    analysisPool->removeClient(analysisHandle);
 }
 
 const juce::String SpectrogramProcessor::getName() const { return JucePlugin_Name; }
@@ -24,30 +27,74 @@ void SpectrogramProcessor::setCurrentProgram(int) {}
 const juce::String SpectrogramProcessor::getProgramName(int) { return {}; }
 void SpectrogramProcessor::changeProgramName(int, const juce::String&) {}
 
+int SpectrogramProcessor::getFFTSizeForId(int id) noexcept
+{
+    for (const auto& choice : fftSizeChoices)
+        if (choice.id == id)
+            return choice.size;
+
+    return 4096;
+}
+
+SpectralAnalyser::WindowType SpectrogramProcessor::getWindowTypeForId(int id) noexcept
+{
+    for (const auto& choice : windowChoices)
+        if (choice.id == id)
+            return choice.type;
+
+    return SpectralAnalyser::WindowType::hann;
+}
+
+SpectralAnalyser::Engine SpectrogramProcessor::getEngineForId(int id) noexcept
+{
+    for (const auto& choice : engineChoices)
+        if (choice.id == id)
+            return choice.engine;
+
+    return SpectralAnalyser::Engine::fft;
+}
+
+int SpectrogramProcessor::getSlidingHopForId(int id, double sampleRate) noexcept
+{
+    for (const auto& choice : slidingHopChoices)
+        if (choice.id == id)
+            return choice.samples > 0 ? choice.samples
+                                      : juce::jmax(1, juce::roundToInt(choice.milliseconds * 0.001 * sampleRate));
+
+    return 64;
+}
+
+DbFormat::Type SpectrogramProcessor::getHistoryFormatForId(int id) noexcept
+{
+    for (const auto& choice : historyFormatChoices)
+        if (choice.id == id)
+            return choice.format;
+
+    return DbFormat::Type::float32;
+}
+
 void SpectrogramProcessor::prepareToPlay(double sampleRate, int)
 {
-    const int bufSize = static_cast<int>(sampleRate) * 2;
-    audioFifo.setSize(bufSize);
-    audioFifo.reset();
+    // The capture ring is about to be resized under the pool's feet
+    analysisPool->removeClient(analysisHandle);
 
-    stereoFifoL.setSize(bufSize);
-    stereoFifoL.reset();
-    stereoFifoR.setSize(bufSize);
-    stereoFifoR.reset();
+    const int bufSize = static_cast<int>(sampleRate) * 2;
+    captureRing.setSize(getTotalNumInputChannels() >= 2 ? 2 : 1, bufSize);
 
-    analyser.prepare(sampleRate, SpectralAnalyser::FFTOrder::order4096);
-    stereoAnalyser.prepare(sampleRate, StereoSpectralAnalyser::FFTOrder::order4096);
+    analyser.prepare(sampleRate, getFFTSizeForId(settings.fftSizeId));
+    history.prepare(sampleRate);
 
-    fifoReadBuffer.resize(static_cast<size_t>(analyser.getFFTSize()));
-    stereoReadBufL.resize(static_cast<size_t>(analyser.getFFTSize()));
-    stereoReadBufR.resize(static_cast<size_t>(analyser.getFFTSize()));
+    // Hops given in milliseconds depend on the rate
+    analyser.setSlidingHop(getSlidingHopForId(settings.slidingHopId, sampleRate));
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
 
-    startTimerHz(60);
+    analysisHandle = analysisPool->addClient([this] { return analyseInput(); },
+                                             editorOpen.load(std::memory_order_relaxed));
 }
 
 void SpectrogramProcessor::releaseResources()
 {
-    stopTimer();
+    analysisPool->removeClient(analysisHandle);
 }
 
 bool SpectrogramProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -72,71 +119,99 @@ void SpectrogramProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
     if (numChannels == 0 || numSamples == 0)
         return;
 
-    // Mix to mono for standard analyser
-    if (numChannels == 1)
-    {
-        audioFifo.push(buffer.getReadPointer(0), numSamples);
-    }
-    else
-    {
-        const float* left = buffer.getReadPointer(0);
-        const float* right = buffer.getReadPointer(1);
-
-        constexpr int chunkSize = 512;
-        float mono[chunkSize];
-
-        for (int offset = 0; offset < numSamples; offset += chunkSize)
-        {
-            const int count = std::min(chunkSize, numSamples - offset);
-            for (int i = 0; i < count; ++i)
-                mono[i] = (left[offset + i] + right[offset + i]) * 0.5f;
+    // Copy the channels as they are; the mixdown happens on the analysis side.
+    // If the host hands us fewer channels than prepared, the first one stands in.
+    const float* channels[CaptureRing::maxChannels] = {
+        buffer.getReadPointer(0),
+        buffer.getReadPointer(numChannels >= 2 ? 1 : 0)
+    };
 
-            audioFifo.push(mono, count);
-        }
-    }
+    captureRing.push(channels, numSamples);
 
-    // Push L/R separately for Nebula mode
-    if (nebulaActive.load(std::memory_order_relaxed) && numChannels >= 2)
-    {
-        stereoFifoL.push(buffer.getReadPointer(0), numSamples);
-        stereoFifoR.push(buffer.getReadPointer(1), numSamples);
-    }
+    if (captureRing.getNumReady() >= samplesPerFrame.load(std::memory_order_relaxed))
+        analysisPool->submit(analysisHandle);
 
     // Audio passes through unchanged
 }
 
-void SpectrogramProcessor::timerCallback()
+int SpectrogramProcessor::analyseInput()
 {
-    // Drain mono FIFO -> analyser
-    {
-        const int available = audioFifo.getNumReady();
-        if (available > 0)
-        {
-            const int toRead = std::min(available, static_cast<int>(fifoReadBuffer.size()));
-            const int read = audioFifo.pop(fifoReadBuffer.data(), toRead);
-            if (read > 0)
-                analyser.pushSamples(fifoReadBuffer.data(), read);
-        }
-    }
+    // One pass feeds both the spectrogram and, in Nebula mode, the stereo view
+    analyser.setStereoOutputsEnabled(nebulaActive.load(std::memory_order_relaxed));
 
-    // Drain stereo FIFOs -> stereo analyser
-    if (nebulaActive.load(std::memory_order_relaxed))
+    // The history takes every mono frame. A short hop or a long backlog can
+    // produce more frames in one go than the analyser's ring holds, so each
+    // call is held to the ring's capacity and the ring drained in between;
+    // that way it never overruns for want of an editor.
+    constexpr int framesPerPass = SpectralAnalyser::getFrameCapacity();
+    int numFrames = 0;
+
+    for (;;)
     {
-        const int availL = stereoFifoL.getNumReady();
-        const int availR = stereoFifoR.getNumReady();
-        const int avail = std::min(availL, availR);
-        if (avail > 0)
+        const int passFrames = analyser.process(captureRing, framesPerPass);
+        numFrames += passFrames;
+
+        const auto layout = analyser.getMonoLayout();
+        SpectralAnalyser::FrameView frame;
+
+        while (analyser.acquireMonoFrame(frame, layout))
         {
-            const int toRead = std::min(avail, static_cast<int>(stereoReadBufL.size()));
-            const int readL = stereoFifoL.pop(stereoReadBufL.data(), toRead);
-            const int readR = stereoFifoR.pop(stereoReadBufR.data(), toRead);
-            const int read = std::min(readL, readR);
-            if (read > 0)
-                stereoAnalyser.pushSamples(stereoReadBufL.data(), stereoReadBufR.data(), read);
+            history.append(frame.monoDb, frame.layout, frame.hop, frame.spacing);
+            analyser.releaseMonoFrame();
         }
+
+        // Fewer means the backlog ran out
+        if (passFrames < framesPerPass)
+            return numFrames;
     }
 }
 
+void SpectrogramProcessor::setEditorOpen(bool isOpen)
+{
+    editorOpen.store(isOpen, std::memory_order_relaxed);
+    analysisPool->setForeground(analysisHandle, isOpen);
+}
+
+void SpectrogramProcessor::setFFTSize(int fftSize)
+{
+    analyser.setFFTSize(fftSize);
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
+}
+
+void SpectrogramProcessor::setOverlap(float overlapFraction)
+{
+    analyser.setOverlap(overlapFraction);
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
+}
+
+void SpectrogramProcessor::setWindowType(SpectralAnalyser::WindowType type)
+{
+    analyser.setWindowType(type);
+}
+
+void SpectrogramProcessor::setEngine(SpectralAnalyser::Engine engine)
+{
+    analyser.setEngine(engine);
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
+}
+
+void SpectrogramProcessor::setZoomBand(float minHz, float maxHz)
+{
+    analyser.setZoomBand(minHz, maxHz);
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
+}
+
+void SpectrogramProcessor::setSlidingHop(int samples)
+{
+    analyser.setSlidingHop(samples);
+    samplesPerFrame.store(analyser.getSamplesPerFrame(), std::memory_order_relaxed);
+}
+
+void SpectrogramProcessor::setDrainPolicy(SpectralAnalyser::DrainPolicy policy, double maxBacklogSeconds)
+{
+    analyser.setDrainPolicy(policy, maxBacklogSeconds);
+}
+
 juce::AudioProcessorEditor* SpectrogramProcessor::createEditor()
 {
     return new SpectrogramEditor(*this);
@@ -150,12 +225,16 @@ void SpectrogramProcessor::getStateInformation(juce::MemoryBlock& destData)
     xml->setAttribute("fftSizeId",      settings.fftSizeId);
     xml->setAttribute("overlapId",      settings.overlapId);
     xml->setAttribute("windowId",       settings.windowId);
+    xml->setAttribute("engineId",       settings.engineId);
+    xml->setAttribute("slidingHopId",   settings.slidingHopId);
+    xml->setAttribute("historyFormatId", settings.historyFormatId);
     xml->setAttribute("colourMapId",    settings.colourMapId);
     xml->setAttribute("logScale",       settings.logScale);
     xml->setAttribute("dbFloor",        static_cast<double>(settings.dbFloor));
     xml->setAttribute("dbCeiling",      static_cast<double>(settings.dbCeiling));
     xml->setAttribute("editorWidth",    settings.editorWidth);
     xml->setAttribute("editorHeight",   settings.editorHeight);
+    xml->setAttribute("aggregateMean",  settings.aggregateMean);
     xml->setAttribute("zoomMinFreq",    static_cast<double>(settings.zoomMinFreq));
     xml->setAttribute("zoomMaxFreq",    static_cast<double>(settings.zoomMaxFreq));
     xml->setAttribute("peakHoldEnabled", settings.peakHoldEnabled);
@@ -177,12 +256,16 @@ void SpectrogramProcessor::setStateInformation(const void* data, int sizeInBytes
     settings.fftSizeId      = xml->getIntAttribute("fftSizeId",      settings.fftSizeId);
     settings.overlapId      = xml->getIntAttribute("overlapId",      settings.overlapId);
     settings.windowId       = xml->getIntAttribute("windowId",       settings.windowId);
+    settings.engineId       = xml->getIntAttribute("engineId",       settings.engineId);
+    settings.slidingHopId   = xml->getIntAttribute("slidingHopId",   settings.slidingHopId);
+    settings.historyFormatId = xml->getIntAttribute("historyFormatId", settings.historyFormatId);
     settings.colourMapId    = xml->getIntAttribute("colourMapId",    settings.colourMapId);
     settings.logScale       = xml->getBoolAttribute("logScale",      settings.logScale);
     settings.dbFloor        = static_cast<float>(xml->getDoubleAttribute("dbFloor",      settings.dbFloor));
     settings.dbCeiling      = static_cast<float>(xml->getDoubleAttribute("dbCeiling",    settings.dbCeiling));
     settings.editorWidth    = xml->getIntAttribute("editorWidth",    settings.editorWidth);
     settings.editorHeight   = xml->getIntAttribute("editorHeight",   settings.editorHeight);
+    settings.aggregateMean  = xml->getBoolAttribute("aggregateMean", settings.aggregateMean);
     settings.zoomMinFreq    = static_cast<float>(xml->getDoubleAttribute("zoomMinFreq",  settings.zoomMinFreq));
     settings.zoomMaxFreq    = static_cast<float>(xml->getDoubleAttribute("zoomMaxFreq",  settings.zoomMaxFreq));
     settings.peakHoldEnabled = xml->getBoolAttribute("peakHoldEnabled", settings.peakHoldEnabled);
@@ -194,19 +277,13 @@ void SpectrogramProcessor::setStateInformation(const void* data, int sizeInBytes
     settings.nebulaMode     = xml->getBoolAttribute("nebulaMode",    settings.nebulaMode);
 
     // Apply analyser settings
-    SpectralAnalyser::FFTOrder order;
-    switch (settings.fftSizeId)
-    {
-        case 1:  order = SpectralAnalyser::FFTOrder::order1024; break;
-        case 2:  order = SpectralAnalyser::FFTOrder::order2048; break;
-        case 4:  order = SpectralAnalyser::FFTOrder::order8192; break;
-        default: order = SpectralAnalyser::FFTOrder::order4096; break;
-    }
-    analyser.prepare(analyser.getSampleRate(), order);
-    analyser.setOverlap(settings.overlapId == 2 ? 0.75f : 0.5f);
-    analyser.setWindowType(settings.windowId == 2
-        ? SpectralAnalyser::WindowType::blackmanHarris
-        : SpectralAnalyser::WindowType::hann);
+    setFFTSize(getFFTSizeForId(settings.fftSizeId));
+    setOverlap(settings.overlapId == 2 ? 0.75f : 0.5f);
+    setWindowType(getWindowTypeForId(settings.windowId));
+    setZoomBand(settings.zoomMinFreq, settings.zoomMaxFreq);
+    setSlidingHop(getSlidingHopForId(settings.slidingHopId, analyser.getSampleRate()));
+    setEngine(getEngineForId(settings.engineId));
+    setHistoryFormat(getHistoryFormatForId(settings.historyFormatId));
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,13 +1,13 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "AudioFifo.h"
+#include "CaptureRing.h"
 #include "SpectralAnalyser.h"
-#include "StereoSpectralAnalyser.h"
+#include "SpectrogramHistory.h"
+#include "AnalysisPool.h"
 #include <atomic>
 
-class SpectrogramProcessor : public juce::AudioProcessor,
-                              private juce::Timer
+class SpectrogramProcessor : public juce::AudioProcessor
 {
 public:
     SpectrogramProcessor();
@@ -39,24 +39,118 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // One engine feeds every consumer; the stereo accessor is kept so Nebula
+    // code reads as such
     SpectralAnalyser& getAnalyser() noexcept { return analyser; }
-    StereoSpectralAnalyser& getStereoAnalyser() noexcept { return stereoAnalyser; }
+    SpectralAnalyser& getStereoAnalyser() noexcept { return analyser; }
 
-    // Set by editor to enable stereo analysis (Nebula mode)
+    // Every mono frame analysed, kept whether or not the editor is open
+    const SpectrogramHistory& getHistory() const noexcept { return history; }
+
+    // How the history stores frames; a new format restarts it
+    void setHistoryFormat(DbFormat::Type format) { history.setFormat(format); }
+
+    // Analysis settings. Safe while a worker is mid-frame: the analyser
+    // publishes a new configuration that the next analysis pass picks up.
+    void setFFTSize(int fftSize);
+    void setOverlap(float overlapFraction);
+    void setWindowType(SpectralAnalyser::WindowType type);
+    void setEngine(SpectralAnalyser::Engine engine);
+    void setZoomBand(float minHz, float maxHz);
+    void setSlidingHop(int samples);
+    void setDrainPolicy(SpectralAnalyser::DrainPolicy policy, double maxBacklogSeconds);
+
+    // Frames analysed and dropped, and samples skipped, by the drain policy
+    SpectralAnalyser::DrainStats getDrainStats() const noexcept { return analyser.getDrainStats(); }
+
+    // Input samples (per channel) dropped because the capture ring was full,
+    // and the number of blocks that happened on
+    uint64_t getCaptureOverflowedSamples() const noexcept { return captureRing.getNumOverflowedSamples(); }
+    uint64_t getCaptureOverflows() const noexcept { return captureRing.getNumOverflows(); }
+
+    // Instances with an open editor get analysed first; hidden ones are best-effort
+    void setEditorOpen(bool isOpen);
+
+    AnalysisPool::Metrics getAnalysisMetrics() const noexcept { return analysisPool->getMetrics(analysisHandle); }
+
+    // Set by editor to enable the stereo outputs (Nebula mode)
     std::atomic<bool> nebulaActive{false};
 
+    // FFT size choices in display order. IDs 1-4 predate the 3 * 2^n and
+    // 5 * 2^n sizes and keep their meaning so saved sessions load unchanged.
+    struct FFTSizeChoice { int id; int size; };
+    static constexpr FFTSizeChoice fftSizeChoices[] = {
+        { 1, 1024 }, { 5, 1536 }, { 2, 2048 }, { 6, 3072 },
+        { 3, 4096 }, { 7, 5120 }, { 8, 6144 }, { 4, 8192 }
+    };
+
+    // Falls back to 4096 for unknown IDs
+    static int getFFTSizeForId(int id) noexcept;
+
+    // Window choices in display order; IDs 1 and 2 are the original two
+    struct WindowChoice { int id; SpectralAnalyser::WindowType type; };
+    static constexpr WindowChoice windowChoices[] = {
+        { 1, SpectralAnalyser::WindowType::hann },
+        { 2, SpectralAnalyser::WindowType::blackmanHarris },
+        { 3, SpectralAnalyser::WindowType::nuttall },
+        { 4, SpectralAnalyser::WindowType::kaiser },
+        { 5, SpectralAnalyser::WindowType::flatTop }
+    };
+
+    // Falls back to Hann for unknown IDs
+    static SpectralAnalyser::WindowType getWindowTypeForId(int id) noexcept;
+
+    // Analysis engine choices in display order
+    struct EngineChoice { int id; SpectralAnalyser::Engine engine; };
+    static constexpr EngineChoice engineChoices[] = {
+        { 1, SpectralAnalyser::Engine::fft },
+        { 2, SpectralAnalyser::Engine::zoom },
+        { 3, SpectralAnalyser::Engine::multiResolution },
+        { 4, SpectralAnalyser::Engine::slidingDFT },
+        { 5, SpectralAnalyser::Engine::reassigned }
+    };
+
+    // Falls back to the FFT for unknown IDs
+    static SpectralAnalyser::Engine getEngineForId(int id) noexcept;
+
+    // Sliding-DFT hop choices in display order, in samples or milliseconds
+    // (exactly one is nonzero)
+    struct SlidingHopChoice { int id; int samples; int milliseconds; const char* name; };
+    static constexpr SlidingHopChoice slidingHopChoices[] = {
+        { 1, 4, 0, "4 smp" }, { 2, 16, 0, "16 smp" }, { 3, 64, 0, "64 smp" },
+        { 4, 256, 0, "256 smp" }, { 5, 0, 1, "1 ms" }, { 6, 0, 5, "5 ms" }
+    };
+
+    // The hop in samples at the given rate; falls back to 64 samples for
+    // unknown IDs
+    static int getSlidingHopForId(int id, double sampleRate) noexcept;
+
+    // History storage formats in display order, widest first
+    struct HistoryFormatChoice { int id; DbFormat::Type format; const char* name; };
+    static constexpr HistoryFormatChoice historyFormatChoices[] = {
+        { 1, DbFormat::Type::float32, "32f" }, { 2, DbFormat::Type::float16, "16f" },
+        { 3, DbFormat::Type::unorm16, "16-bit" }, { 4, DbFormat::Type::unorm8, "8-bit" }
+    };
+
+    // Falls back to 32-bit floats for unknown IDs
+    static DbFormat::Type getHistoryFormatForId(int id) noexcept;
+
     // Persistent display settings (editor reads/writes these)
     struct Settings
     {
-        int fftSizeId       = 3;    // ComboBox ID: 1=1024, 2=2048, 3=4096, 4=8192
+        int fftSizeId       = 3;    // ComboBox ID, see fftSizeChoices
         int overlapId       = 1;    // 1=50%, 2=75%
-        int windowId        = 1;    // 1=Hann, 2=Blackman-Harris
+        int windowId        = 1;    // ComboBox ID, see windowChoices
+        int engineId        = 1;    // ComboBox ID, see engineChoices
+        int slidingHopId    = 3;    // ComboBox ID, see slidingHopChoices
+        int historyFormatId = 1;    // ComboBox ID, see historyFormatChoices
         int colourMapId     = 1;    // 1..8
         bool logScale       = true;
         float dbFloor       = -90.0f;
         float dbCeiling     = 0.0f;
         int editorWidth     = 900;
         int editorHeight    = 520;
+        bool aggregateMean  = false;   // columns and rows: mean power rather than max
 
         // Phase 2: Zoom
         float zoomMinFreq   = 20.0f;
@@ -81,21 +175,24 @@ public:
     Settings settings;
 
 private:
-    void timerCallback() override;
+    // Runs on an analysis pool worker; returns the number of frames produced
+    int analyseInput();
 
     static constexpr int fifoCapacity = 48000;
 
-    AudioFifo audioFifo{fifoCapacity};
+    // Raw input channels; the analyser mixes down or packs them as needed
+    CaptureRing captureRing{2, fifoCapacity};
+
     SpectralAnalyser analyser;
+    SpectrogramHistory history;
 
-    // Stereo FIFOs for Nebula mode
-    AudioFifo stereoFifoL{fifoCapacity};
-    AudioFifo stereoFifoR{fifoCapacity};
-    StereoSpectralAnalyser stereoAnalyser;
+    // The analyser's samples per frame, readable from processBlock: a frame
+    // can be analysed once this many samples are waiting
+    std::atomic<int> samplesPerFrame{4096};
 
-    std::vector<float> fifoReadBuffer;
-    std::vector<float> stereoReadBufL;
-    std::vector<float> stereoReadBufR;
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+    AnalysisPool::Handle analysisHandle;
+    std::atomic<bool> editorOpen{false};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramProcessor)
 };
@@ -0,0 +1,168 @@
+#include "Reassignment.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // Bins quieter than about -140 dB relative to a full-scale tone aren't
+    // worth moving, and their reassigned positions are mostly rounding noise
+    constexpr float minRelativePower = 1.0e-14f;
+
+    std::atomic<uint64_t> nextPlanId{ 1 };
+}
+
+std::shared_ptr<const Reassignment::Plan> Reassignment::createPlan(double sampleRate, int fftSize, int hopSize,
+                                                                  WindowBank::Type windowType)
+{
+    jassert(sampleRate > 0.0 && fftSize > 0 && fftSize <= maxFFTSize && hopSize > 0);
+
+    auto plan = std::make_shared<Plan>();
+    plan->id = nextPlanId.fetch_add(1);
+    plan->sampleRate = sampleRate;
+    plan->fftSize = fftSize;
+    plan->hop = hopSize;
+
+    const int halfSize = fftSize / 2;
+    plan->oversample = juce::jlimit(1, maxOversample, (maxOutputBins - 1) / halfSize);
+    plan->span = juce::jlimit(1, maxSpan, (halfSize + hopSize - 1) / hopSize);
+
+    plan->window = WindowBank::get(windowType, fftSize);
+    const float* w = plan->window->data;
+
+    // Central differences; the window is zero (or nearly) beyond both ends
+    const double centre = 0.5 * (fftSize - 1);
+    plan->derivativeWindow.resize(static_cast<size_t>(fftSize));
+    plan->timeWindow.resize(static_cast<size_t>(fftSize));
+
+    for (int n = 0; n < fftSize; ++n)
+    {
+        const float before = n > 0 ? w[n - 1] : 0.0f;
+        const float after = n < fftSize - 1 ? w[n + 1] : 0.0f;
+
+        plan->derivativeWindow[static_cast<size_t>(n)] = 0.5f * (after - before);
+        plan->timeWindow[static_cast<size_t>(n)] = static_cast<float>((n - centre) * w[n]);
+    }
+
+    plan->fft = FFTBackends::createFastest(fftSize);
+
+    const auto hann = WindowBank::get(WindowBank::Type::hann, fftSize);
+    plan->normalisationDb = 20.0f * std::log10(hann->coherentGain / plan->window->coherentGain)
+                          - 20.0f * std::log10(static_cast<float>(fftSize))
+                          - 10.0f * std::log10(plan->window->enbw);
+
+    plan->layout.numBins = halfSize * plan->oversample + 1;
+    plan->layout.minHz = 0.0;
+    plan->layout.maxHz = sampleRate * 0.5;
+
+    return plan;
+}
+
+//==============================================================================
+Reassignment::Reassignment()
+{
+    columns.resize(static_cast<size_t>(maxColumns) * maxOutputBins);
+
+    spectrum.resize(2 * maxFFTSize);
+    packedInput.resize(maxFFTSize);
+    packedSpectrum.resize(maxFFTSize);
+
+    reset();
+}
+
+void Reassignment::prepare(const Plan& plan) noexcept
+{
+    if (plan.id == preparedPlanId)
+        return;
+
+    reset();
+    preparedPlanId = plan.id;
+}
+
+void Reassignment::reset() noexcept
+{
+    std::fill(columns.begin(), columns.end(), 0.0f);
+    framesPushed = 0;
+}
+
+bool Reassignment::push(const Plan& plan, const float* frame) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    const int fftSize = plan.fftSize;
+    auto* work = spectrum.data();
+
+    DspKernels::applyWindow(work, frame, plan.window->data, fftSize);
+    std::fill(work + fftSize, work + 2 * fftSize, 0.0f);
+    plan.fft->performRealForward(work);
+
+    // x dh as the real part and x th as the imaginary part: the pair kernel
+    // with the frame standing in for the window
+    DspKernels::applyWindowPair(reinterpret_cast<float*>(packedInput.data()), plan.derivativeWindow.data(),
+                                plan.timeWindow.data(), frame, fftSize);
+    plan.fft->performForward(packedInput.data(), packedSpectrum.data());
+
+    const auto* packed = reinterpret_cast<const float*>(packedSpectrum.data());
+    const int numColumns = 2 * plan.span + 1;
+    const int lastOutputBin = plan.layout.numBins - 1;
+    const float binsPerRadian = static_cast<float>(fftSize / juce::MathConstants<double>::twoPi);
+    const float outputBinsPerBin = static_cast<float>(plan.oversample);
+    const float hopsPerSample = 1.0f / static_cast<float>(plan.hop);
+    const float minPower = minRelativePower * static_cast<float>(fftSize) * static_cast<float>(fftSize);
+
+    // The newest column this frame reaches takes over from one handed out
+    // (or passed over) already
+    const auto newest = static_cast<size_t>((framesPushed + plan.span) % numColumns);
+    std::fill_n(columns.data() + newest * maxOutputBins, plan.layout.numBins, 0.0f);
+
+    // Columns before the first frame since a reset were never shown
+    const int earliest = -static_cast<int>(juce::jmin(static_cast<int64_t>(plan.span), framesPushed));
+
+    for (int k = 0; k <= fftSize / 2; ++k)
+    {
+        const float re = work[2 * k];
+        const float im = work[2 * k + 1];
+        const float power = re * re + im * im;
+
+        if (power < minPower)
+            continue;
+
+        // Conjugate-symmetry split: X_dh = (Z[k] + conj Z[N - k]) / 2 and
+        // X_th = (Z[k] - conj Z[N - k]) / 2i
+        const int mirror = (fftSize - k) % fftSize;
+        const float zRe = packed[2 * k], zIm = packed[2 * k + 1];
+        const float mRe = packed[2 * mirror], mIm = packed[2 * mirror + 1];
+
+        const float dRe = 0.5f * (zRe + mRe), dIm = 0.5f * (zIm - mIm);
+        const float tRe = 0.5f * (zIm + mIm), tIm = 0.5f * (mRe - zRe);
+
+        // Im(X_dh conj(X_h)) and Re(X_th conj(X_h)), over |X_h|^2
+        const float frequencyOffset = -(dIm * re - dRe * im) / power * binsPerRadian;
+        const float timeOffset = (tRe * re + tIm * im) / power;
+
+        const int outputBin = static_cast<int>(std::lround((static_cast<float>(k) + frequencyOffset) * outputBinsPerBin));
+
+        if (outputBin < 0 || outputBin > lastOutputBin)
+            continue;
+
+        const int column = juce::jlimit(earliest, plan.span, static_cast<int>(std::lround(timeOffset * hopsPerSample)));
+        const auto slot = static_cast<size_t>((framesPushed + column + numColumns) % numColumns);
+
+        columns[slot * maxOutputBins + static_cast<size_t>(outputBin)] += power;
+    }
+
+    // Frame f reaches back to column f - span, so this frame was the last
+    // that could add to the column span frames back
+    return ++framesPushed > plan.span;
+}
+
+void Reassignment::analyse(const Plan& plan, float* destDb) noexcept
+{
+    jassert(plan.id == preparedPlanId && framesPushed > plan.span);
+
+    const int numColumns = 2 * plan.span + 1;
+    const auto slot = static_cast<size_t>((framesPushed - 1 - plan.span) % numColumns);
+
+    DspKernels::powerToDb(columns.data() + slot * maxOutputBins, destDb, plan.layout.numBins, plan.normalisationDb);
+}
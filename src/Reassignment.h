@@ -0,0 +1,107 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "BinLayout.h"
+#include "FFTBackend.h"
+#include "WindowBank.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Reassigned spectrogram. Besides the usual windowed transform X_h, each
+// frame takes two more with the window's derivative (X_dh) and the window
+// times time from its centre (X_th), both real, so one complex FFT yields
+// them together. For each bin they give where its energy actually comes
+// from,
+//
+//   frequency  k - Im(X_dh conj(X_h)) / |X_h|^2 * N / (2 pi)   bins
+//   time       Re(X_th conj(X_h)) / |X_h|^2                    samples
+//
+// and the energy is moved there instead of being spread over the bin and
+// the frame: a partial's main lobe collapses onto its true frequency and a
+// click's energy onto the column it happened in. A short FFT reassigned
+// this way draws partials about as sharply as a much longer one, without
+// the long window's smearing in time.
+//
+// Frequencies land on a grid finer than the FFT's bins (Plan::oversample
+// per bin). Times land on a neighbouring frame's column, up to Plan::span
+// hops either side, so a column is only complete once the frames that can
+// reach it have been analysed, span hops later.
+class Reassignment
+{
+public:
+    static constexpr int maxFFTSize = 8192;
+
+    // Output bins per FFT bin, at most; less where that would exceed the
+    // bins an 8192 FFT has
+    static constexpr int maxOversample = 4;
+
+    // Immutable once built; shared through the analyser's published Config
+    struct Plan
+    {
+        uint64_t id = 0;
+
+        double sampleRate = 0.0;
+        int fftSize = 0;
+        int hop = 0;                // input samples between frames
+        int oversample = 1;         // output bins per FFT bin
+        int span = 0;               // columns energy can move either side
+
+        std::shared_ptr<const WindowBank::Table> window;
+
+        // The window's derivative per sample, and the window times the
+        // distance in samples from its centre
+        std::vector<float> derivativeWindow, timeWindow;
+
+        std::shared_ptr<FFTBackend> fft;
+
+        // Like the analyser's own frames, calibrated to Hann, and less the
+        // window's noise bandwidth: a steady tone's main lobe is summed into
+        // one output bin rather than read at its peak
+        float normalisationDb = 0.0f;
+
+        BinLayout layout;
+    };
+
+    // hopSize is the analyser's frame hop in input samples
+    static std::shared_ptr<const Plan> createPlan(double sampleRate, int fftSize, int hopSize,
+                                                  WindowBank::Type windowType);
+
+    // Allocates for the largest plan; nothing allocates afterwards
+    Reassignment();
+
+    // Clears the pending columns when plan isn't the one the state was
+    // built for; otherwise does nothing
+    void prepare(const Plan& plan) noexcept;
+
+    // Forgets everything, e.g. after input was skipped
+    void reset() noexcept;
+
+    // Analyses one frame of plan.fftSize contiguous samples, plan.hop on
+    // from the last, and moves its energy to where it came from. Returns
+    // true when the oldest pending column can't receive any more and
+    // analyse() has a frame to give.
+    bool push(const Plan& plan, const float* frame) noexcept;
+
+    // Hands out the oldest complete column as plan.layout.numBins dB values
+    void analyse(const Plan& plan, float* destDb) noexcept;
+
+private:
+    // The analyser's overlap tops out at 87.5%, a hop of an eighth of the
+    // window, so energy moves at most half a window: 4 hops
+    static constexpr int maxSpan = 4;
+    static constexpr int maxColumns = 2 * maxSpan + 1;
+    static constexpr int maxOutputBins = maxFFTSize / 2 + 1;
+
+    // Power accumulated for the frames around the newest, one column per
+    // frame, used round robin
+    std::vector<float> columns;
+    int64_t framesPushed = 0;
+
+    // X_h as interleaved complex, and X_dh and X_th packed into one
+    // complex transform as its real and imaginary parts
+    std::vector<float> spectrum;
+    std::vector<FFTBackend::Complex> packedInput, packedSpectrum;
+
+    uint64_t preparedPlanId = 0;
+};
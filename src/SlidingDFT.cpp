@@ -0,0 +1,208 @@
+#include "SlidingDFT.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    std::atomic<uint64_t> nextPlanId{ 1 };
+}
+
+std::shared_ptr<const SlidingDFT::Plan> SlidingDFT::createPlan(double sampleRate, int windowLength, int hop,
+                                                              double minHz, double maxHz,
+                                                              WindowBank::Type windowType)
+{
+    jassert(sampleRate > 0.0 && windowLength > 0 && windowLength <= maxWindowLength);
+
+    auto plan = std::make_shared<Plan>();
+    plan->id = nextPlanId.fetch_add(1);
+    plan->sampleRate = sampleRate;
+    plan->windowLength = windowLength;
+    plan->hop = juce::jlimit(1, windowLength, hop);
+
+    auto terms = WindowBank::getCosineTerms(windowType);
+
+    if (terms.numTerms == 0)
+        terms = WindowBank::getCosineTerms(WindowBank::Type::hann);
+
+    // Multiplying by cos(2 pi t n / N) in time adds the bins t either side,
+    // each at half weight
+    const int span = terms.numTerms - 1;
+    plan->windowSpan = span;
+    plan->windowWeights.resize(static_cast<size_t>(terms.numTerms));
+    plan->windowWeights[0] = static_cast<float>(terms.a[0]);
+
+    for (int t = 1; t < terms.numTerms; ++t)
+        plan->windowWeights[static_cast<size_t>(t)] = static_cast<float>(((t & 1) != 0 ? -0.5 : 0.5) * terms.a[t]);
+
+    // Keep the neighbours within 0 .. Nyquist so they're all real DFT bins
+    const double binHz = sampleRate / windowLength;
+    const int firstBin = juce::jlimit(span, windowLength / 2 - span, static_cast<int>(std::ceil(minHz / binHz)));
+    const int lastBin = juce::jlimit(firstBin, windowLength / 2 - span, static_cast<int>(std::floor(maxHz / binHz)));
+
+    plan->layout.numBins = lastBin - firstBin + 1;
+    plan->layout.minHz = firstBin * binHz;
+    plan->layout.maxHz = lastBin * binHz;
+
+    plan->firstTrackedBin = firstBin - span;
+    plan->numTrackedBins = plan->layout.numBins + 2 * span;
+    plan->twiddleRe.resize(static_cast<size_t>(plan->numTrackedBins));
+    plan->twiddleIm.resize(static_cast<size_t>(plan->numTrackedBins));
+
+    for (int i = 0; i < plan->numTrackedBins; ++i)
+    {
+        const double phase = juce::MathConstants<double>::twoPi * (plan->firstTrackedBin + i) / windowLength;
+        plan->twiddleRe[static_cast<size_t>(i)] = static_cast<float>(std::cos(phase));
+        plan->twiddleIm[static_cast<size_t>(i)] = static_cast<float>(std::sin(phase));
+    }
+
+    plan->fft = FFTBackends::createFastest(windowLength);
+
+    // A periodic cosine-sum window's coherent gain is its first term
+    plan->normalisationDb = 20.0f * std::log10(0.5f / static_cast<float>(terms.a[0]))
+                          - 20.0f * std::log10(static_cast<float>(windowLength));
+
+    return plan;
+}
+
+//==============================================================================
+SlidingDFT::SlidingDFT()
+{
+    constexpr size_t maxBins = maxWindowLength / 2 + 1;
+
+    history.resize(2 * maxWindowLength);
+    binRe.resize(maxBins);
+    binIm.resize(maxBins);
+
+    mono.resize(maxWindowLength);
+    delta.resize(maxWindowLength);
+    windowedRe.resize(maxBins);
+    windowedIm.resize(maxBins);
+    power.resize(maxBins);
+    fftWork.resize(2 * maxWindowLength);
+
+    reset();
+}
+
+void SlidingDFT::prepare(const Plan& plan) noexcept
+{
+    if (plan.id == preparedPlanId)
+        return;
+
+    reset();
+    preparedPlanId = plan.id;
+}
+
+void SlidingDFT::reset() noexcept
+{
+    // The DFT of silence is zero, so the bins and history agree
+    std::fill(history.begin(), history.end(), 0.0f);
+    std::fill(binRe.begin(), binRe.end(), 0.0f);
+    std::fill(binIm.begin(), binIm.end(), 0.0f);
+    historyPos = 0;
+    samplesSinceRecompute = 0;
+}
+
+void SlidingDFT::push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    for (int done = 0; done < numSamples;)
+    {
+        // Blocks end where the bins are due to be recomputed
+        const int num = juce::jmin(plan.windowLength - samplesSinceRecompute, numSamples - done);
+        pushBlock(plan, left + done, right != nullptr ? right + done : nullptr, num);
+        done += num;
+
+        samplesSinceRecompute += num;
+
+        if (samplesSinceRecompute == plan.windowLength)
+            recompute(plan);
+    }
+}
+
+void SlidingDFT::pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept
+{
+    const auto& kernels = DspKernels::get();
+    const int length = plan.windowLength;
+    const float* in = left;
+
+    if (right != nullptr)
+    {
+        kernels.mixToMono(mono.data(), left, right, num);
+        in = mono.data();
+    }
+
+    // The sample leaving the window is the one about to be overwritten
+    for (int i = 0; i < num; ++i)
+    {
+        delta[static_cast<size_t>(i)] = in[i] - history[static_cast<size_t>(historyPos)];
+        history[static_cast<size_t>(historyPos)] = history[static_cast<size_t>(historyPos + length)] = in[i];
+
+        if (++historyPos == length)
+            historyPos = 0;
+    }
+
+    kernels.slidingDft(binRe.data(), binIm.data(), plan.twiddleRe.data(), plan.twiddleIm.data(),
+                       plan.numTrackedBins, delta.data(), num);
+}
+
+void SlidingDFT::recompute(const Plan& plan) noexcept
+{
+    const int length = plan.windowLength;
+    auto* work = fftWork.data();
+
+    // Oldest to newest starts at the write position, as the recurrence has it
+    std::copy(history.data() + historyPos, history.data() + historyPos + length, work);
+    std::fill(work + length, work + 2 * length, 0.0f);
+
+    plan.fft->performRealForward(work);
+
+    const auto* bins = work + 2 * plan.firstTrackedBin;
+
+    for (int i = 0; i < plan.numTrackedBins; ++i)
+    {
+        binRe[static_cast<size_t>(i)] = bins[2 * i];
+        binIm[static_cast<size_t>(i)] = bins[2 * i + 1];
+    }
+
+    samplesSinceRecompute = 0;
+}
+
+void SlidingDFT::analyse(const Plan& plan, float* destDb) noexcept
+{
+    jassert(plan.id == preparedPlanId);
+
+    const int numBins = plan.layout.numBins;
+    const int span = plan.windowSpan;
+    const float* re = binRe.data() + span;
+    const float* im = binIm.data() + span;
+    float* outRe = windowedRe.data();
+    float* outIm = windowedIm.data();
+
+    // One pass per window term, each running over every bin
+    const float centre = plan.windowWeights[0];
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        outRe[i] = centre * re[i];
+        outIm[i] = centre * im[i];
+    }
+
+    for (int t = 1; t <= span; ++t)
+    {
+        const float weight = plan.windowWeights[static_cast<size_t>(t)];
+
+        for (int i = 0; i < numBins; ++i)
+        {
+            outRe[i] += weight * (re[i - t] + re[i + t]);
+            outIm[i] += weight * (im[i - t] + im[i + t]);
+        }
+    }
+
+    for (int i = 0; i < numBins; ++i)
+        power[static_cast<size_t>(i)] = outRe[i] * outRe[i] + outIm[i] * outIm[i];
+
+    DspKernels::powerToDb(power.data(), destDb, numBins, plan.normalisationDb);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include "BinLayout.h"
+#include "FFTBackend.h"
+#include "WindowBank.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Sliding DFT over the zoom range, for hops down to a few samples. Each bin
+// of a windowLength-point DFT is updated in place as every sample arrives,
+//
+//   X'[k] = (X[k] + x_new - x_oldest) * exp(i 2 pi k / windowLength),
+//
+// so the cost is the bins in view times the sample rate, plus a windowing
+// and dB pass per hop, whatever the hop. An FFT per hop costs a whole
+// transform each time and stops being practical long before the hop gets
+// that short.
+//
+// The window is applied in the frequency domain, which works for the
+// cosine-sum windows: a Hann window is X[k] / 2 - (X[k - 1] + X[k + 1]) / 4.
+// Kaiser isn't a cosine sum, and Hann stands in for it. The sums are the
+// periodic forms of the windows the FFT path uses; the difference is far
+// below anything visible.
+//
+// The recurrence is run in single precision. Rounding makes the bins drift
+// slowly, so every windowLength samples they're recomputed outright from
+// one FFT of the input history.
+class SlidingDFT
+{
+public:
+    static constexpr int maxWindowLength = 8192;
+
+    // Immutable once built; shared through the analyser's published Config
+    struct Plan
+    {
+        uint64_t id = 0;
+
+        double sampleRate = 0.0;
+        int windowLength = 0;
+        int hop = 0;                // input samples per frame
+
+        // The bins the recurrence tracks: the output bins plus the
+        // neighbours the window reads on either side
+        int firstTrackedBin = 0;
+        int numTrackedBins = 0;
+        int windowSpan = 0;         // neighbours read on each side
+
+        // Weight of X[k], X[k +- 1], ... in the windowed bin
+        std::vector<float> windowWeights;
+
+        // exp(i 2 pi k / windowLength) for each tracked bin
+        std::vector<float> twiddleRe, twiddleIm;
+
+        // For recomputing the bins outright
+        std::shared_ptr<FFTBackend> fft;
+
+        // 20 * log10(1 / windowLength) plus the window's gain relative to
+        // Hann, like the analyser's own frames
+        float normalisationDb = 0.0f;
+
+        BinLayout layout;
+    };
+
+    // The output covers the DFT bins from minHz to maxHz. hop is clamped to
+    // 1 .. windowLength.
+    static std::shared_ptr<const Plan> createPlan(double sampleRate, int windowLength, int hop,
+                                                  double minHz, double maxHz,
+                                                  WindowBank::Type windowType);
+
+    // Allocates for the largest plan; nothing allocates afterwards
+    SlidingDFT();
+
+    // Clears the bins and history when plan isn't the one the state was
+    // built for; otherwise does nothing
+    void prepare(const Plan& plan) noexcept;
+
+    // Forgets everything, e.g. after input was skipped
+    void reset() noexcept;
+
+    // Slides the bins over new input. right may be nullptr for mono input;
+    // otherwise the two are mixed down.
+    void push(const Plan& plan, const float* left, const float* right, int numSamples) noexcept;
+
+    // Windows the bins as they stand into plan.layout.numBins dB values
+    void analyse(const Plan& plan, float* destDb) noexcept;
+
+private:
+    void pushBlock(const Plan& plan, const float* left, const float* right, int num) noexcept;
+    void recompute(const Plan& plan) noexcept;
+
+    // Input history, written twice windowLength apart so the current window
+    // is always contiguous from historyPos
+    std::vector<float> history;
+    int historyPos = 0;
+    int samplesSinceRecompute = 0;
+
+    std::vector<float> binRe, binIm;
+
+    // Scratch: the mixdown and x_new - x_oldest for a block, the windowed
+    // bins, and the FFT's in-place buffer
+    std::vector<float> mono, delta;
+    std::vector<float> windowedRe, windowedIm, power;
+    std::vector<float> fftWork;
+
+    uint64_t preparedPlanId = 0;
+};
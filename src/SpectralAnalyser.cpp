@@ -1,155 +1,855 @@
 #include "SpectralAnalyser.h"
+#include "DspKernels.h"
 #include <cmath>
 #include <algorithm>
+#include <thread>
 
 SpectralAnalyser::SpectralAnalyser()
 {
-    frameBuffer.resize(maxFrames);
+    fftWorkBuffer.resize(static_cast<size_t>(maxFFTSize) * 2, 0.0f);
+    packedInput.resize(static_cast<size_t>(maxFFTSize));
+    spectrum.resize(static_cast<size_t>(maxFFTSize));
+
+    // One extra cache line so the slab can start on a 64-byte boundary
+    frameSlabStorage.calloc(static_cast<size_t>(maxFrames) * numPlanes * planeStride + 16);
+    frameSlab = juce::snapPointerToAlignment(frameSlabStorage.get(), 64);
+
+    // No FFT plan until prepare(): probing the backends isn't something to do
+    // in a constructor
+    auto config = std::make_unique<Config>();
+    updateHopSize(*config);
+    selectWindow(*config);
+    currentConfig.store(new PublishedConfig(std::move(*config)), std::memory_order_release);
 }
 
-void SpectralAnalyser::prepare(double sampleRate, FFTOrder order)
+SpectralAnalyser::~SpectralAnalyser()
 {
-    currentSampleRate = sampleRate;
-    fftOrder = static_cast<int>(order);
-    fftSize = 1 << fftOrder;
-    hopSize = static_cast<int>(fftSize * (1.0f - overlapFraction));
-
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    jassert(registeringReaders.load() == 0 && currentConfig.load()->readers.load() == 0);
+    delete currentConfig.load();
+}
 
-    windowBuffer.resize(static_cast<size_t>(fftSize));
-    buildWindow();
+void SpectralAnalyser::prepare(double sampleRate, int newFFTSize)
+{
+    const juce::ScopedLock sl(configLock);
 
-    inputBuffer.resize(static_cast<size_t>(fftSize), 0.0f);
-    inputWritePos = 0;
-    samplesUntilNextFrame = 0;
+    auto config = copyCurrentConfig();
+    config->sampleRate = sampleRate;
+    applyFFTSize(*config, newFFTSize);
+    publish(std::move(config));
 
-    fftWorkBuffer.resize(static_cast<size_t>(fftSize) * 2, 0.0f);
+    analysedFrames.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    droppedSamples.store(0, std::memory_order_relaxed);
+    lastBacklogFrames.store(0, std::memory_order_relaxed);
+    overrunFrames.store(0, std::memory_order_relaxed);
+}
 
-    const int numBins = getNumBins();
-    for (auto& frame : frameBuffer)
-        frame.resize(static_cast<size_t>(numBins), -100.0f);
+void SpectralAnalyser::setFFTSize(int newFFTSize)
+{
+    const juce::ScopedLock sl(configLock);
 
-    frameWritePos.store(0, std::memory_order_relaxed);
-    frameReadPos.store(0, std::memory_order_relaxed);
+    auto config = copyCurrentConfig();
+    applyFFTSize(*config, newFFTSize);
+    publish(std::move(config));
 }
 
 void SpectralAnalyser::setWindowType(WindowType type)
 {
-    windowType = type;
-    buildWindow();
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->windowType = type;
+    selectWindow(*config);
+    updateEnginePlans(*config);
+    publish(std::move(config));
 }
 
 void SpectralAnalyser::setOverlap(float fraction)
 {
-    overlapFraction = juce::jlimit(0.0f, 0.875f, fraction);
-    hopSize = static_cast<int>(fftSize * (1.0f - overlapFraction));
-    if (hopSize < 1) hopSize = 1;
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->overlapFraction = juce::jlimit(0.0f, 0.875f, fraction);
+    updateHopSize(*config);
+    updateEnginePlans(*config);
+    publish(std::move(config));
+}
+
+const char* SpectralAnalyser::getEngineName(Engine engine) noexcept
+{
+    switch (engine)
+    {
+        case Engine::fft:             return "FFT";
+        case Engine::zoom:            return "Zoom";
+        case Engine::multiResolution: return "Multi-res";
+        case Engine::slidingDFT:      return "Sliding";
+        case Engine::reassigned:      return "Reassign";
+    }
+    return "";
 }
 
-void SpectralAnalyser::buildWindow()
+void SpectralAnalyser::setEngine(Engine engine)
 {
-    const auto N = static_cast<size_t>(fftSize);
-    windowBuffer.resize(N);
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->engine = engine;
+    updateEnginePlans(*config);
+    publish(std::move(config));
+}
+
+SpectralAnalyser::Engine SpectralAnalyser::getEngine() const noexcept
+{
+    const ConfigReader config(*this);
+    return config->engine;
+}
+
+void SpectralAnalyser::setZoomBand(double minHz, double maxHz)
+{
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->zoomMinHz = juce::jmax(0.0, minHz);
+    config->zoomMaxHz = juce::jmax(config->zoomMinHz, maxHz);
+    updateEnginePlans(*config);
+    publish(std::move(config));
+}
+
+void SpectralAnalyser::setSlidingHop(int samples)
+{
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->slidingHop = juce::jlimit(1, maxFFTSize, samples);
+    updateEnginePlans(*config);
+    publish(std::move(config));
+}
+
+void SpectralAnalyser::setDrainPolicy(DrainPolicy policy, double maxSeconds)
+{
+    const juce::ScopedLock sl(configLock);
+
+    auto config = copyCurrentConfig();
+    config->drainPolicy = policy;
+    config->maxBacklogSeconds = juce::jmax(0.0, maxSeconds);
+    publish(std::move(config));
+}
+
+SpectralAnalyser::DrainPolicy SpectralAnalyser::getDrainPolicy() const noexcept
+{
+    const ConfigReader config(*this);
+    return config->drainPolicy;
+}
+
+int SpectralAnalyser::getFFTSize() const noexcept
+{
+    const ConfigReader config(*this);
+    return config->fftSize;
+}
+
+double SpectralAnalyser::getSampleRate() const noexcept
+{
+    const ConfigReader config(*this);
+    return config->sampleRate;
+}
+
+BinLayout SpectralAnalyser::getMonoLayout() const noexcept
+{
+    const ConfigReader config(*this);
+
+    switch (getActiveEngine(*config))
+    {
+        case Engine::zoom:            return config->zoomPlan->layout;
+        case Engine::multiResolution: return config->multiResolutionPlan->layout;
+        case Engine::slidingDFT:      return config->slidingPlan->layout;
+        case Engine::reassigned:      return config->reassignmentPlan->layout;
+        case Engine::fft:             break;
+    }
+
+    return getFFTLayout(*config);
+}
+
+int SpectralAnalyser::getSamplesPerFrame() const noexcept
+{
+    const ConfigReader config(*this);
+
+    // Not switched with the stereo outputs: while they force the FFT path a
+    // hop just means a few wake-ups that find no complete window
+    if (config->slidingPlan != nullptr)
+        return config->slidingPlan->hop;
+
+    return config->zoomPlan != nullptr || config->multiResolutionPlan != nullptr ? config->hopSize
+                                                                                 : config->fftSize;
+}
+
+//==============================================================================
+SpectralAnalyser::ConfigReader::ConfigReader(const SpectralAnalyser& owner) noexcept
+{
+    // Announce the registration before loading the pointer. Both are
+    // sequentially consistent, as is the writer's swap-then-check, so a
+    // writer that sees no one registering knows every later reader will load
+    // the new Config, and sees the count of every earlier one.
+    owner.registeringReaders.fetch_add(1);
+    published = owner.currentConfig.load();
+    published->readers.fetch_add(1, std::memory_order_relaxed);
+    owner.registeringReaders.fetch_sub(1, std::memory_order_release);
+}
+
+SpectralAnalyser::ConfigReader::~ConfigReader()
+{
+    published->readers.fetch_sub(1, std::memory_order_release);
+}
+
+std::unique_ptr<SpectralAnalyser::Config> SpectralAnalyser::copyCurrentConfig() const
+{
+    // Only writers store to currentConfig, and they hold configLock
+    return std::make_unique<Config>(currentConfig.load(std::memory_order_relaxed)->config);
+}
+
+void SpectralAnalyser::publish(std::unique_ptr<Config> newConfig)
+{
+    auto* published = new PublishedConfig(std::move(*newConfig));
+    retiredConfigs.emplace_back(currentConfig.exchange(published));
+    reclaimRetiredConfigs();
+}
+
+void SpectralAnalyser::reclaimRetiredConfigs()
+{
+    // A reader still registering may be about to count itself on a Config
+    // just retired. That takes a few instructions, so it's waited out.
+    while (registeringReaders.load() != 0)
+        std::this_thread::yield();
+
+    // Readers hold a Config for at most one process() call or getter, so one
+    // still in use is freed at the next change instead
+    retiredConfigs.erase(std::remove_if(retiredConfigs.begin(), retiredConfigs.end(),
+                                        [](const auto& retired) { return retired->readers.load(std::memory_order_acquire) == 0; }),
+                         retiredConfigs.end());
+}
+
+void SpectralAnalyser::applyFFTSize(Config& config, int newFFTSize)
+{
+    jassert(newFFTSize <= maxFFTSize && FFTBackends::isSupportedSize(newFFTSize));
 
-    switch (windowType)
+    config.fftSize = newFFTSize;
+
+    // Re-preparing at the same size keeps the existing plan
+    if (config.fft == nullptr || config.fft->getSize() != newFFTSize)
+        config.fft = FFTBackends::createFastest(newFFTSize);
+
+    config.sizedKernels = DspKernels::getSized(newFFTSize);
+
+    updateHopSize(config);
+    selectWindow(config);
+    updateEnginePlans(config);
+}
+
+void SpectralAnalyser::updateHopSize(Config& config)
+{
+    config.hopSize = juce::jmax(1, static_cast<int>(config.fftSize * (1.0f - config.overlapFraction)));
+}
+
+void SpectralAnalyser::selectWindow(Config& config)
+{
+    config.window = WindowBank::get(config.windowType, config.fftSize);
+
+    // Levels stay calibrated to Hann, which the display has always used: other
+    // windows are scaled by their coherent gain relative to Hann's at the same
+    // size, so a tone's peak doesn't move when the window changes
+    const auto hann = WindowBank::get(WindowType::hann, config.fftSize);
+    const float windowCorrectionDb = 20.0f * std::log10(hann->coherentGain / config.window->coherentGain);
+    const auto N = static_cast<float>(config.fftSize);
+
+    config.monoNormalisationDb = windowCorrectionDb - 20.0f * std::log10(N);
+    config.packedMidSideNormalisationDb = windowCorrectionDb - 20.0f * std::log10(4.0f * N);
+    config.packedStereoNormalisationDb = windowCorrectionDb - 20.0f * std::log10(2.0f * N);
+}
+
+void SpectralAnalyser::updateEnginePlans(Config& config)
+{
+    config.zoomPlan.reset();
+    config.multiResolutionPlan.reset();
+    config.slidingPlan.reset();
+    config.reassignmentPlan.reset();
+
+    // Nothing to plan for before prepare()
+    if (config.fft == nullptr)
+        return;
+
+    if (config.engine == Engine::multiResolution)
+    {
+        auto plan = MultiResolution::createPlan(config.sampleRate, config.fftSize,
+                                                config.hopSize, config.windowType);
+        jassert(plan->layout.numBins <= maxBins);
+        config.multiResolutionPlan = std::move(plan);
+        return;
+    }
+
+    if (config.engine == Engine::slidingDFT)
     {
-        case WindowType::hann:
+        auto plan = SlidingDFT::createPlan(config.sampleRate, config.fftSize, config.slidingHop,
+                                           config.zoomMinHz, config.zoomMaxHz, config.windowType);
+        jassert(plan->layout.numBins <= maxBins);
+        config.slidingPlan = std::move(plan);
+        return;
+    }
+
+    if (config.engine == Engine::reassigned)
+    {
+        auto plan = Reassignment::createPlan(config.sampleRate, config.fftSize,
+                                             config.hopSize, config.windowType);
+        jassert(plan->layout.numBins <= maxBins);
+        config.reassignmentPlan = std::move(plan);
+        return;
+    }
+
+    if (config.engine != Engine::zoom)
+        return;
+
+    auto plan = BandZoom::createPlan(config.sampleRate, config.fftSize,
+                                     config.zoomMinHz, config.zoomMaxHz, config.windowType);
+
+    // Without a single halving the zoom would only transform the same window
+    // at a larger size; the full-band FFT is cheaper and shows the same thing
+    if (plan->numStages == 0 || plan->layout.numBins < 2)
+        return;
+
+    jassert(plan->layout.numBins <= maxBins);
+    config.zoomPlan = std::move(plan);
+}
+
+BinLayout SpectralAnalyser::getFFTLayout(const Config& config) noexcept
+{
+    return { config.fftSize / 2 + 1, 0.0, config.sampleRate * 0.5, false };
+}
+
+SpectralAnalyser::Engine SpectralAnalyser::getActiveEngine(const Config& config) const noexcept
+{
+    // Nebula needs the stereo outputs, which only the FFT path produces
+    if (stereoOutputsEnabled.load(std::memory_order_relaxed))
+        return Engine::fft;
+
+    if (config.zoomPlan != nullptr)
+        return Engine::zoom;
+
+    if (config.multiResolutionPlan != nullptr)
+        return Engine::multiResolution;
+
+    if (config.slidingPlan != nullptr)
+        return Engine::slidingDFT;
+
+    if (config.reassignmentPlan != nullptr)
+        return Engine::reassigned;
+
+    return Engine::fft;
+}
+
+int SpectralAnalyser::getHopSize(const Config& config, Engine engine) noexcept
+{
+    return engine == Engine::slidingDFT ? config.slidingPlan->hop : config.hopSize;
+}
+
+bool SpectralAnalyser::isStreaming(Engine engine) noexcept
+{
+    return engine == Engine::zoom || engine == Engine::multiResolution || engine == Engine::slidingDFT;
+}
+
+void SpectralAnalyser::prepareEngine(const Config& config, Engine engine) noexcept
+{
+    // Coming back to an engine after other frames, its history is stale
+    if (streamedEngine != engine)
+        resetEngine(engine);
+
+    switch (engine)
+    {
+        case Engine::zoom:            zoom.prepare(*config.zoomPlan); break;
+        case Engine::multiResolution: multiResolution.prepare(*config.multiResolutionPlan); break;
+        case Engine::slidingDFT:      slidingDFT.prepare(*config.slidingPlan); break;
+        case Engine::reassigned:      reassignment.prepare(*config.reassignmentPlan); break;
+        case Engine::fft:             break;
+    }
+
+    streamedEngine = engine;
+}
+
+void SpectralAnalyser::resetEngine(Engine engine) noexcept
+{
+    switch (engine)
+    {
+        case Engine::zoom:            zoom.reset(); break;
+        case Engine::multiResolution: multiResolution.reset(); break;
+        case Engine::slidingDFT:      slidingDFT.reset(); break;
+        case Engine::reassigned:      reassignment.reset(); break;
+        case Engine::fft:             break;
+    }
+}
+
+SpectralAnalyser::DrainStats SpectralAnalyser::getDrainStats() const noexcept
+{
+    DrainStats stats;
+    stats.analysedFrames = analysedFrames.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames.load(std::memory_order_relaxed);
+    stats.droppedSamples = droppedSamples.load(std::memory_order_relaxed);
+    stats.lastBacklogFrames = lastBacklogFrames.load(std::memory_order_relaxed);
+    stats.overrunFrames = overrunFrames.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int SpectralAnalyser::process(CaptureRing& input, int maxFramesOut)
+{
+    // Held for the whole call: a change published meanwhile applies from the
+    // next call on
+    const ConfigReader config(*this);
+
+    if (config->fft == nullptr)
+    {
+        jassertfalse;   // process() before prepare()
+        return 0;
+    }
+
+    const int fftSize = config->fftSize;
+    const auto engine = getActiveEngine(*config);
+    const int hopSize = getHopSize(*config, engine);
+    const bool streaming = isStreaming(engine);
+
+    // The streaming engines keep their own history, so each hop of input is
+    // a frame
+    const int frameLength = streaming ? hopSize : fftSize;
+
+    // Measure the backlog once; anything arriving meanwhile is the next call's
+    // work, so one call's cost stays bounded
+    const int available = input.getNumReady();
+
+    int backlogFrames = available >= frameLength ? (available - frameLength) / hopSize + 1 : 0;
+    lastBacklogFrames.store(backlogFrames, std::memory_order_relaxed);
+
+    if (backlogFrames == 0)
+        return 0;
+
+    prepareEngine(*config, engine);
+
+    const int budgetFrames = juce::jmax(1, static_cast<int>(std::ceil(config->maxBacklogSeconds * config->sampleRate / hopSize)));
+    int stride = 1;
+
+    // Reassignment moves energy between consecutive frames by their time
+    // offsets in hops, so it has to see every frame; it skips instead
+    auto drainPolicy = config->drainPolicy;
+
+    if (drainPolicy == DrainPolicy::decimate && engine == Engine::reassigned)
+        drainPolicy = DrainPolicy::skipToLatest;
+
+    if (backlogFrames > budgetFrames)
+    {
+        if (drainPolicy == DrainPolicy::skipToLatest)
         {
-            for (size_t i = 0; i < N; ++i)
-            {
-                double x = static_cast<double>(i) / static_cast<double>(N - 1);
-                windowBuffer[i] = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * juce::MathConstants<double>::pi * x)));
-            }
-            break;
+            const int skipFrames = backlogFrames - budgetFrames;
+            const int skipSamples = skipFrames * hopSize;
+
+            input.discard(skipSamples);
+
+            // The engines' history can't bridge the gap
+            resetEngine(engine);
+
+            backlogFrames = budgetFrames;
+            droppedFrames.fetch_add(static_cast<uint64_t>(skipFrames), std::memory_order_relaxed);
+            droppedSamples.fetch_add(static_cast<uint64_t>(skipSamples), std::memory_order_relaxed);
         }
-        case WindowType::blackmanHarris:
+        else if (drainPolicy == DrainPolicy::decimate)
         {
-            constexpr double a0 = 0.35875, a1 = 0.48829, a2 = 0.14128, a3 = 0.01168;
-            for (size_t i = 0; i < N; ++i)
-            {
-                double x = static_cast<double>(i) / static_cast<double>(N - 1);
-                double w = a0
-                         - a1 * std::cos(2.0 * juce::MathConstants<double>::pi * x)
-                         + a2 * std::cos(4.0 * juce::MathConstants<double>::pi * x)
-                         - a3 * std::cos(6.0 * juce::MathConstants<double>::pi * x);
-                windowBuffer[i] = static_cast<float>(w);
-            }
-            break;
+            stride = (backlogFrames + budgetFrames - 1) / budgetFrames;
+        }
+    }
+
+    int numFrames = 0, numAttempted = 0;
+    int frame = 0, lastAttempted = -1;
+    CaptureRing::Region region;
+
+    for (; frame < backlogFrames && numFrames < maxFramesOut; ++frame)
+    {
+        // A streaming engine sees every hop, whether or not it's analysed
+        if (streaming)
+        {
+            if (!input.peek(hopSize, region))
+                break;
+
+            pushToEngine(*config, engine, input, region);
         }
+
+        // Decimation keeps every stride-th frame counting back from the newest
+        if ((backlogFrames - 1 - frame) % stride == 0)
+        {
+            if (!streaming && !input.peek(fftSize, region))
+                break;
+
+            if (analyseFrame(*config, engine, (frame - lastAttempted) * hopSize, input, region))
+                ++numFrames;
+
+            ++numAttempted;
+            lastAttempted = frame;
+        }
+
+        input.discard(hopSize);
     }
+
+    analysedFrames.fetch_add(static_cast<uint64_t>(numFrames), std::memory_order_relaxed);
+    droppedFrames.fetch_add(static_cast<uint64_t>(frame - numAttempted), std::memory_order_relaxed);
+
+    return numFrames;
 }
 
-void SpectralAnalyser::pushSamples(const float* data, int numSamples)
+bool SpectralAnalyser::analyseFrame(const Config& config, Engine engine, int spacing,
+                                    const CaptureRing& input, const CaptureRing::Region& region)
 {
-    for (int i = 0; i < numSamples; ++i)
+    // Nothing to publish until the oldest pending column is complete
+    if (engine == Engine::reassigned && !pushToReassignment(config, input, region))
+        return false;
+
+    const int writeIdx = frameWritePos.load(std::memory_order_relaxed);
+
+    if (!makeRoomForFrame(writeIdx))
+        return false;
+
+    if (engine == Engine::zoom)
+        processZoomFrame(*config.zoomPlan, writeIdx);
+    else if (engine == Engine::multiResolution)
+        processMultiResolutionFrame(*config.multiResolutionPlan, writeIdx);
+    else if (engine == Engine::slidingDFT)
+        processSlidingFrame(*config.slidingPlan, writeIdx);
+    else if (engine == Engine::reassigned)
+        processReassignedFrame(*config.reassignmentPlan, writeIdx);
+    else if (input.getNumChannels() > 1 && stereoOutputsEnabled.load(std::memory_order_relaxed))
+        processStereoFrame(config, writeIdx, input, region);
+    else
+        processMonoFrame(config, writeIdx, input, region);
+
+    auto& info = slotInfo[static_cast<size_t>(writeIdx)];
+    info.hop = getHopSize(config, engine);
+    info.spacing = spacing;
+    frameWritePos.store((writeIdx + 1) % maxFrames, std::memory_order_release);
+    return true;
+}
+
+bool SpectralAnalyser::makeRoomForFrame(int writeIdx) noexcept
+{
+    // Publishing this frame would leave a cursor on the next slot looking as
+    // if it had nothing to read, and the frame after it would be written
+    // over the slot that cursor is on
+    const int next = (writeIdx + 1) % maxFrames;
+
+    for (auto* cursor : { &monoCursor, &stereoCursor })
     {
-        inputBuffer[static_cast<size_t>(inputWritePos)] = data[i];
-        ++inputWritePos;
+        auto state = cursor->load(std::memory_order_acquire);
 
-        if (inputWritePos >= fftSize)
+        while (positionOf(state) == next)
         {
-            processNextFFTFrame();
-
-            // Shift by hopSize: move the tail of the buffer to the front
-            const int remaining = fftSize - hopSize;
-            std::memmove(inputBuffer.data(),
-                         inputBuffer.data() + hopSize,
-                         sizeof(float) * static_cast<size_t>(remaining));
-            inputWritePos = remaining;
+            // The consumer is reading that slot right now: drop the new frame
+            if (isHeld(state))
+            {
+                overrunFrames.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Otherwise it loses its oldest frame. A stereo consumer stepping
+            // over a frame without stereo outputs loses nothing.
+            if (cursor->compare_exchange_weak(state, static_cast<uint32_t>((next + 1) % maxFrames),
+                                              std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                if (cursor == &monoCursor || slotInfo[static_cast<size_t>(next)].hasStereo)
+                    overrunFrames.fetch_add(1, std::memory_order_relaxed);
+
+                break;
+            }
         }
     }
+
+    return true;
 }
 
-void SpectralAnalyser::processNextFFTFrame()
+void SpectralAnalyser::processMonoFrame(const Config& config, int slot,
+                                        const CaptureRing& input, const CaptureRing::Region& region)
 {
+    const int fftSize = config.fftSize;
     const auto N = static_cast<size_t>(fftSize);
+    const auto* windowBuffer = config.window->data;
+    const auto& kernels = DspKernels::get();
+    const auto* sized = config.sizedKernels;
+    auto* work = fftWorkBuffer.data();
 
-    // Copy input and apply window into work buffer
-    for (size_t i = 0; i < N; ++i)
-        fftWorkBuffer[i] = inputBuffer[i] * windowBuffer[i];
+    // The frame may wrap, so each channel arrives as two spans; both channels
+    // wrap at the same offset. Most frames don't, and take the fixed-size
+    // kernels in one piece.
+    CaptureRing::Span firstL, secondL;
+    input.getSpans(region, 0, firstL, secondL);
+    const bool contiguous = sized != nullptr && secondL.size == 0;
+
+    if (input.getNumChannels() == 1)
+    {
+        // Window straight out of the ring
+        if (contiguous)
+        {
+            sized->applyWindow(work, firstL.data, windowBuffer);
+        }
+        else
+        {
+            kernels.applyWindow(work, firstL.data, windowBuffer, firstL.size);
+            kernels.applyWindow(work + firstL.size, secondL.data, windowBuffer + firstL.size, secondL.size);
+        }
+    }
+    else
+    {
+        // Mix down and window in one pass out of the ring
+        CaptureRing::Span firstR, secondR;
+        input.getSpans(region, 1, firstR, secondR);
+
+        if (contiguous)
+        {
+            sized->mixAndWindow(work, firstL.data, firstR.data, windowBuffer);
+        }
+        else
+        {
+            kernels.mixAndWindow(work, firstL.data, firstR.data, windowBuffer, firstL.size);
+            kernels.mixAndWindow(work + firstL.size, secondL.data, secondR.data,
+                                 windowBuffer + firstL.size, secondL.size);
+        }
+    }
 
     // Zero the imaginary part
-    std::memset(fftWorkBuffer.data() + N, 0, sizeof(float) * N);
+    std::memset(work + N, 0, sizeof(float) * N);
 
     // In-place FFT: input is fftSize reals, output is interleaved complex
-    fft->performRealOnlyForwardTransform(fftWorkBuffer.data(), true);
+    config.fft->performRealForward(work);
 
-    // Convert to magnitude dB
-    const int numBins = getNumBins();
-    const int writeIdx = frameWritePos.load(std::memory_order_relaxed);
-    auto& destFrame = frameBuffer[static_cast<size_t>(writeIdx)];
+    // Convert to magnitude dB, normalised by FFT size and clamped to -100 dB
+    const int numBins = fftSize / 2 + 1;
+    auto* monoDb = getPlane(slot, monoPlane);
 
-    for (int bin = 0; bin < numBins; ++bin)
+    if (sized != nullptr)
+        sized->complexToDb(work, monoDb, config.monoNormalisationDb);
+    else
+        kernels.complexToDb(work, monoDb, numBins, config.monoNormalisationDb);
+
+    slotInfo[static_cast<size_t>(slot)] = { getFFTLayout(config), false };
+}
+
+void SpectralAnalyser::processStereoFrame(const Config& config, int slot,
+                                          const CaptureRing& input, const CaptureRing::Region& region)
+{
+    const int fftSize = config.fftSize;
+    const auto* windowBuffer = config.window->data;
+    const auto& kernels = DspKernels::get();
+    const auto* sized = config.sizedKernels;
+    auto* packed = reinterpret_cast<float*>(packedInput.data());
+
+    CaptureRing::Span firstL, secondL, firstR, secondR;
+    input.getSpans(region, 0, firstL, secondL);
+    input.getSpans(region, 1, firstR, secondR);
+
+    // Window both channels straight out of the ring into one complex buffer:
+    // L as the real part, R as the imaginary part
+    if (sized != nullptr && secondL.size == 0)
+    {
+        sized->applyWindowPair(packed, firstL.data, firstR.data, windowBuffer);
+    }
+    else
     {
-        float real = fftWorkBuffer[static_cast<size_t>(bin * 2)];
-        float imag = fftWorkBuffer[static_cast<size_t>(bin * 2 + 1)];
-        float magnitude = std::sqrt(real * real + imag * imag);
+        kernels.applyWindowPair(packed, firstL.data, firstR.data, windowBuffer, firstL.size);
+        kernels.applyWindowPair(packed + firstL.size * 2, secondL.data, secondR.data,
+                                windowBuffer + firstL.size, secondL.size);
+    }
+
+    // One complex FFT covers both channels
+    config.fft->performForward(packedInput.data(), spectrum.data());
 
-        // Normalise by FFT size
-        magnitude /= static_cast<float>(fftSize);
+    const int numBins = fftSize / 2 + 1;
+    auto* monoDb = getPlane(slot, monoPlane);
+    auto* sideDb = getPlane(slot, sidePlane);
+    auto* stereoDb = getPlane(slot, stereoPlane);
+    auto* pan = getPlane(slot, panPlane);
+    const auto* bins = reinterpret_cast<const float*>(spectrum.data());
 
-        // Convert to dB, clamped to a floor of -100 dB
-        float db = (magnitude > 0.0f)
-                       ? 20.0f * std::log10(magnitude)
-                       : -100.0f;
-        destFrame[static_cast<size_t>(bin)] = std::max(db, -100.0f);
+    // Conjugate-symmetry split into L and R. Mid, side and the stereo
+    // magnitude come out as power, converted to dB in place below.
+    if (sized != nullptr)
+    {
+        sized->splitStereo(bins, monoDb, sideDb, stereoDb, pan);
+        sized->powerToDb(monoDb, monoDb, config.packedMidSideNormalisationDb);
+        sized->powerToDb(sideDb, sideDb, config.packedMidSideNormalisationDb);
+        sized->powerToDb(stereoDb, stereoDb, config.packedStereoNormalisationDb);
+    }
+    else
+    {
+        kernels.splitStereo(bins, monoDb, sideDb, stereoDb, pan, fftSize);
+        kernels.powerToDb(monoDb, monoDb, numBins, config.packedMidSideNormalisationDb);
+        kernels.powerToDb(sideDb, sideDb, numBins, config.packedMidSideNormalisationDb);
+        kernels.powerToDb(stereoDb, stereoDb, numBins, config.packedStereoNormalisationDb);
     }
 
-    frameWritePos.store((writeIdx + 1) % maxFrames, std::memory_order_release);
+    slotInfo[static_cast<size_t>(slot)] = { getFFTLayout(config), true };
+}
+
+void SpectralAnalyser::pushToEngine(const Config& config, Engine engine,
+                                    const CaptureRing& input, const CaptureRing::Region& region)
+{
+    // Mixed down inside the engine, the same (L + R) / 2 as the FFT path
+    const auto push = [&](const float* left, const float* right, int num)
+    {
+        if (engine == Engine::zoom)
+            zoom.push(*config.zoomPlan, left, right, num);
+        else if (engine == Engine::multiResolution)
+            multiResolution.push(*config.multiResolutionPlan, left, right, num);
+        else
+            slidingDFT.push(*config.slidingPlan, left, right, num);
+    };
+
+    CaptureRing::Span firstL, secondL;
+    input.getSpans(region, 0, firstL, secondL);
+
+    if (input.getNumChannels() == 1)
+    {
+        push(firstL.data, nullptr, firstL.size);
+        push(secondL.data, nullptr, secondL.size);
+        return;
+    }
+
+    CaptureRing::Span firstR, secondR;
+    input.getSpans(region, 1, firstR, secondR);
+
+    push(firstL.data, firstR.data, firstL.size);
+    push(secondL.data, secondR.data, secondL.size);
+}
+
+void SpectralAnalyser::processZoomFrame(const BandZoom::Plan& plan, int slot)
+{
+    zoom.analyse(plan, getPlane(slot, monoPlane));
+    slotInfo[static_cast<size_t>(slot)] = { plan.layout, false };
+}
+
+void SpectralAnalyser::processMultiResolutionFrame(const MultiResolution::Plan& plan, int slot)
+{
+    multiResolution.analyse(plan, getPlane(slot, monoPlane));
+    slotInfo[static_cast<size_t>(slot)] = { plan.layout, false };
+}
+
+bool SpectralAnalyser::pushToReassignment(const Config& config, const CaptureRing& input,
+                                          const CaptureRing::Region& region)
+{
+    // Gathered into one contiguous mixdown, as the three transforms all
+    // read it
+    auto* frame = fftWorkBuffer.data();
+
+    CaptureRing::Span firstL, secondL;
+    input.getSpans(region, 0, firstL, secondL);
+
+    if (input.getNumChannels() == 1)
+    {
+        std::copy(firstL.data, firstL.data + firstL.size, frame);
+        std::copy(secondL.data, secondL.data + secondL.size, frame + firstL.size);
+    }
+    else
+    {
+        CaptureRing::Span firstR, secondR;
+        input.getSpans(region, 1, firstR, secondR);
+
+        DspKernels::mixToMono(frame, firstL.data, firstR.data, firstL.size);
+        DspKernels::mixToMono(frame + firstL.size, secondL.data, secondR.data, secondL.size);
+    }
+
+    return reassignment.push(*config.reassignmentPlan, frame);
+}
+
+void SpectralAnalyser::processReassignedFrame(const Reassignment::Plan& plan, int slot)
+{
+    reassignment.analyse(plan, getPlane(slot, monoPlane));
+    slotInfo[static_cast<size_t>(slot)] = { plan.layout, false };
 }
 
-bool SpectralAnalyser::pullNextFrame(float* destMagnitudesDb, int numBins)
+void SpectralAnalyser::processSlidingFrame(const SlidingDFT::Plan& plan, int slot)
 {
-    int w = frameWritePos.load(std::memory_order_acquire);
-    int r = frameReadPos.load(std::memory_order_relaxed);
+    slidingDFT.analyse(plan, getPlane(slot, monoPlane));
+    slotInfo[static_cast<size_t>(slot)] = { plan.layout, false };
+}
 
-    if (r == w)
+bool SpectralAnalyser::acquireMonoFrame(FrameView& view, const BinLayout& layout)
+{
+    const int slot = acquireSlot(monoCursor, false, layout);
+
+    if (slot < 0)
         return false;
 
-    const auto& srcFrame = frameBuffer[static_cast<size_t>(r)];
-    const int toCopy = std::min(numBins, static_cast<int>(srcFrame.size()));
-    std::memcpy(destMagnitudesDb, srcFrame.data(), sizeof(float) * static_cast<size_t>(toCopy));
+    fillView(slot, view);
+    return true;
+}
+
+void SpectralAnalyser::releaseMonoFrame()
+{
+    releaseSlot(monoCursor);
+}
+
+bool SpectralAnalyser::acquireStereoFrame(FrameView& view)
+{
+    const int slot = acquireSlot(stereoCursor, true, {});
 
-    frameReadPos.store((r + 1) % maxFrames, std::memory_order_release);
+    if (slot < 0)
+        return false;
+
+    fillView(slot, view);
     return true;
 }
+
+void SpectralAnalyser::releaseStereoFrame()
+{
+    releaseSlot(stereoCursor);
+}
+
+int SpectralAnalyser::acquireSlot(std::atomic<uint32_t>& cursor, bool stereoOnly, const BinLayout& layout) noexcept
+{
+    auto state = cursor.load(std::memory_order_acquire);
+    jassert(!isHeld(state));    // the previous frame was never released
+
+    for (;;)
+    {
+        const int r = positionOf(state);
+
+        if (r == frameWritePos.load(std::memory_order_acquire))
+            return -1;
+
+        // Hold the slot before looking at it, so the writer can't skip past
+        // it and reuse it meanwhile. On failure the writer has just moved the
+        // cursor; state now holds the new position.
+        if (!cursor.compare_exchange_weak(state, state | heldFlag,
+                                          std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        const auto& info = slotInfo[static_cast<size_t>(r)];
+
+        if (stereoOnly ? info.hasStereo : info.layout == layout)
+            return r;
+
+        // Not one for this consumer (a frame without stereo outputs, or one
+        // from before a settings change): step over it
+        state = static_cast<uint32_t>((r + 1) % maxFrames);
+        cursor.store(state, std::memory_order_release);
+    }
+}
+
+void SpectralAnalyser::releaseSlot(std::atomic<uint32_t>& cursor) noexcept
+{
+    const auto state = cursor.load(std::memory_order_relaxed);
+    jassert(isHeld(state));
+
+    // The writer never moves a held cursor, so a plain store is enough
+    cursor.store(static_cast<uint32_t>((positionOf(state) + 1) % maxFrames), std::memory_order_release);
+}
+
+void SpectralAnalyser::fillView(int slot, FrameView& view) const noexcept
+{
+    const auto& info = slotInfo[static_cast<size_t>(slot)];
+
+    view.monoDb = getPlane(slot, monoPlane);
+    view.sideDb = info.hasStereo ? getPlane(slot, sidePlane) : nullptr;
+    view.stereoDb = info.hasStereo ? getPlane(slot, stereoPlane) : nullptr;
+    view.pan = info.hasStereo ? getPlane(slot, panPlane) : nullptr;
+    view.layout = info.layout;
+    view.hop = info.hop;
+    view.spacing = info.spacing;
+}
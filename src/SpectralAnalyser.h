@@ -2,66 +2,392 @@
 
 #include <juce_dsp/juce_dsp.h>
 #include <juce_core/juce_core.h>
+#include "BandZoom.h"
+#include "BinLayout.h"
+#include "CaptureRing.h"
+#include "FFTBackend.h"
+#include "MultiResolution.h"
+#include "Reassignment.h"
+#include "SlidingDFT.h"
+#include "DspKernels.h"
+#include "WindowBank.h"
+#include <array>
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <limits>
 
+// One analysis engine for every consumer. Each input channel is transformed
+// once per hop and all outputs are derived from those complex bins:
+//
+//   mono / mid   (L + R) / 2    spectrogram, RTA, peak hold
+//   side         (L - R) / 2
+//   stereo       (|L| + |R|) / 2 and pan, for Nebula
+//
+// With the stereo outputs enabled the two channels are packed into a single
+// complex FFT (L real, R imaginary) and split by conjugate symmetry. Without
+// them the channels are mixed down first and one real FFT suffices. Mono is
+// the same linear combination either way, so the display doesn't change when
+// Nebula is toggled.
+//
+// Frames land in one ring; the mono and stereo consumers each keep their own
+// cursor into it. The ring is a single 64-byte-aligned slab with one plane per
+// output (structure of arrays), and consumers read a slot in place through a
+// FrameView that they release when done. The writer never overwrites a held
+// slot: when a consumer falls a whole ring behind, its oldest unread frame is
+// skipped, or if it's holding that one the new frame is dropped, and either
+// way the overrun is counted.
+//
+// The settings (FFT size, window, overlap, drain policy) live in an immutable
+// Config. A change builds a complete new Config on the calling thread,
+// including the FFT plan and a shared table from the WindowBank, and publishes it with one atomic
+// pointer swap; process() picks it up at its next call, so a size change
+// mid-playback never stalls or allocates on the analysis side. Each Config
+// counts the readers holding it, and a replaced one is deleted at the next
+// change once its count is zero. The frame ring and scratch buffers are sized for
+// maxFFTSize up front and never reallocate; each frame records its own bin
+// layout.
+//
+// The zoom engine replaces the full-band mono frames with a band-limited
+// analysis of the zoom range (see BandZoom) at the same resolution as the
+// FFT size. It streams every input sample through its decimators, so a frame
+// needs only a hop of new input rather than a whole window. Stereo frames
+// always come from the full-band FFT, and a band too wide to decimate falls
+// back to it as well.
+//
+// The multi-resolution engine likewise streams its input, through an octave
+// bank of decimated transforms (see MultiResolution), and publishes
+// log-spaced mono frames: the FFT size's resolution in the bass with a short
+// window's time resolution in the treble.
+//
+// The sliding-DFT engine tracks the zoom range's bins of an fftSize-point
+// DFT sample by sample (see SlidingDFT) and publishes a frame every
+// slidingHop samples, independent of the overlap, for time resolution down
+// to a few samples.
+//
+// The reassignment engine takes the FFT engine's frames, with two extra
+// transforms each, and moves every bin's energy to the time and frequency
+// it came from (see Reassignment), for sharp partials from a short FFT. Its
+// frames are published a few hops late, once no later frame can add to them.
 class SpectralAnalyser
 {
 public:
-    enum class WindowType { hann, blackmanHarris };
-    enum class FFTOrder { order1024 = 10, order2048 = 11, order4096 = 12, order8192 = 13 };
+    using WindowType = WindowBank::Type;
+
+    static constexpr int maxFFTSize = 8192;
 
     SpectralAnalyser();
+    ~SpectralAnalyser();
+
+    // Any size FFTBackends::isSupportedSize accepts, up to maxFFTSize:
+    // powers of two as well as 3 * 2^n and 5 * 2^n. Also resets the drain
+    // stats.
+    void prepare(double sampleRate, int fftSize);
 
-    void prepare(double sampleRate, FFTOrder order);
+    // Like prepare(), but keeps the sample rate and the stats. Safe to call
+    // while process() is running on another thread.
+    void setFFTSize(int fftSize);
 
     void setWindowType(WindowType type);
     void setOverlap(float overlapFraction);
 
-    void pushSamples(const float* data, int numSamples);
+    enum class Engine { fft, zoom, multiResolution, slidingDFT, reassigned };
+    static const char* getEngineName(Engine engine) noexcept;
+
+    void setEngine(Engine engine);
+    Engine getEngine() const noexcept;
+
+    // The range the zoom engine concentrates on; kept while the FFT engine
+    // is active
+    void setZoomBand(double minHz, double maxHz);
+
+    // Input samples per frame for the sliding-DFT engine, clamped to
+    // 1 .. fftSize when the plan is built
+    void setSlidingHop(int samples);
+
+    // Side, stereo magnitude and pan are only computed while enabled
+    void setStereoOutputsEnabled(bool shouldBeEnabled) noexcept { stereoOutputsEnabled = shouldBeEnabled; }
+    bool areStereoOutputsEnabled() const noexcept { return stereoOutputsEnabled; }
+
+    // What process() does when the input has piled up beyond the backlog
+    // budget, e.g. after the analysis was starved of CPU:
+    //   catchUp       analyse every frame, however late the display gets
+    //   skipToLatest  drop the oldest input so only the budget's worth is left
+    //   decimate      analyse an evenly spaced subset of the backlog, ending
+    //                 on the newest frame; the reassignment engine, which
+    //                 needs every frame, skips to the latest instead
+    enum class DrainPolicy { catchUp, skipToLatest, decimate };
+
+    void setDrainPolicy(DrainPolicy policy, double maxBacklogSeconds);
+    DrainPolicy getDrainPolicy() const noexcept;
+
+    struct DrainStats
+    {
+        uint64_t analysedFrames = 0;
+        uint64_t droppedFrames = 0;     // skipped or decimated away
+        uint64_t droppedSamples = 0;    // input discarded unanalysed (skipToLatest)
+        int lastBacklogFrames = 0;      // frames waiting at the start of the last process()
+
+        // Frames a consumer missed because it fell a whole ring behind
+        uint64_t overrunFrames = 0;
+    };
+
+    // Totals since prepare(); safe to read from any thread
+    DrainStats getDrainStats() const noexcept;
+
+    // Measures the backlog waiting in the capture ring and drains it,
+    // reading the windowed input straight out of the ring and consuming one hop
+    // per frame. The drain policy applies when the backlog exceeds the budget.
+    // A one-channel ring is analysed as mono. Stops after maxFramesOut
+    // frames, leaving the rest of the backlog in the ring for the next call.
+    // Returns the number of frames produced. One thread at a time.
+    int process(CaptureRing& input, int maxFramesOut = std::numeric_limits<int>::max());
+
+    // One analysed frame, read in place. The planes stay valid until the
+    // frame is released.
+    struct FrameView
+    {
+        const float* monoDb = nullptr;      // mono / mid, (L + R) / 2
+        const float* sideDb = nullptr;      // (L - R) / 2; null unless a stereo frame
+        const float* stereoDb = nullptr;    // (|L| + |R|) / 2; null unless a stereo frame
+        const float* pan = nullptr;         // -1 = full L, 0 = centre, +1 = full R; null unless a stereo frame
+        BinLayout layout;
+        int hop = 0;                        // input samples per frame when it was analysed
+        int spacing = 0;                    // input samples since the previous frame: hop, or
+                                            // a multiple of it where frames were decimated away
+    };
 
-    bool pullNextFrame(float* destMagnitudesDb, int numBins);
+    // Mono (mid) consumer. Frames whose layout isn't the given one, i.e. ones
+    // analysed before a settings change, are skipped. Each successful
+    // acquire must be released before the next one.
+    bool acquireMonoFrame(FrameView& view, const BinLayout& layout);
+    void releaseMonoFrame();
 
-    int getFFTSize() const noexcept { return fftSize; }
-    int getNumBins() const noexcept { return fftSize / 2 + 1; }
-    double getSampleRate() const noexcept { return currentSampleRate; }
+    // Stereo consumer. Frames analysed while the stereo outputs were disabled
+    // are skipped.
+    bool acquireStereoFrame(FrameView& view);
+    void releaseStereoFrame();
 
+    // The most recently published settings; process() may still be finishing
+    // a call with the previous ones
+    int getFFTSize() const noexcept;
+    int getNumBins() const noexcept { return getFFTSize() / 2 + 1; }
+    double getSampleRate() const noexcept;
+
+    // The layout new mono frames are analysed with: the zoom band, the
+    // multi-resolution engine's log-spaced bins, or the full band up to
+    // Nyquist
+    BinLayout getMonoLayout() const noexcept;
+
+    // New input that lets process() produce a frame: a whole window for the
+    // FFT engine, a hop for the streaming engines
+    int getSamplesPerFrame() const noexcept;
+
+    // The most unread frames the ring holds before the oldest is lost
+    static constexpr int getFrameCapacity() noexcept { return maxFrames - 1; }
+
+    // Unread mono frames, including one that's currently acquired
     int getNumFramesAvailable() const noexcept
     {
         int w = frameWritePos.load(std::memory_order_acquire);
-        int r = frameReadPos.load(std::memory_order_acquire);
+        int r = positionOf(monoCursor.load(std::memory_order_acquire));
         return (w - r + maxFrames) % maxFrames;
     }
 
 private:
-    void buildWindow();
-    void processNextFFTFrame();
+    static constexpr int maxFrames = 256;
+    static constexpr int maxBins = maxFFTSize / 2 + 1;
+
+    // Each plane padded to a whole number of cache lines
+    static constexpr int planeStride = (maxBins + 15) & ~15;
+
+    enum Plane { monoPlane, sidePlane, stereoPlane, panPlane, numPlanes };
+
+    // Everything process() needs to know about the settings. Never modified
+    // once published.
+    struct Config
+    {
+        double sampleRate = 44100.0;
+        int fftSize = 4096;
+        float overlapFraction = 0.5f;
+        int hopSize = 2048;
+        WindowType windowType = WindowType::hann;
+        Engine engine = Engine::fft;
+        double zoomMinHz = 20.0;
+        double zoomMaxHz = 20000.0;
+        int slidingHop = 64;
+        DrainPolicy drainPolicy = DrainPolicy::skipToLatest;
+        double maxBacklogSeconds = 0.5;
+
+        // Shared with the Config it was copied from when only other settings
+        // changed. Only the thread running process() calls into it.
+        std::shared_ptr<FFTBackend> fft;
+        std::shared_ptr<const WindowBank::Table> window;
 
-    double currentSampleRate = 44100.0;
+        // Kernels compiled for exactly this FFT size, if it's one of the
+        // specialised sizes; otherwise the generic ones are used
+        const DspKernels::SizedTable* sizedKernels = nullptr;
 
-    int fftOrder = 12;
-    int fftSize = 4096;
+        // 20 * log10(1 / fftSize) for the real transform of the mixdown, plus
+        // the window's gain correction (see selectWindow)
+        float monoNormalisationDb = 0.0f;
 
-    std::unique_ptr<juce::dsp::FFT> fft;
+        // The packed split yields 2 L[k] and 2 R[k], so mid and side come out as
+        // 4x and the stereo magnitude as 2x their normalised value
+        float packedMidSideNormalisationDb = 0.0f;
+        float packedStereoNormalisationDb = 0.0f;
 
-    WindowType windowType = WindowType::hann;
-    std::vector<float> windowBuffer;
+        // Set while the zoom engine is selected and the band is narrow
+        // enough to decimate; otherwise mono frames come from the FFT
+        std::shared_ptr<const BandZoom::Plan> zoomPlan;
 
-    float overlapFraction = 0.5f;
-    int hopSize = 2048;
+        // Set while the multi-resolution engine is selected
+        std::shared_ptr<const MultiResolution::Plan> multiResolutionPlan;
 
-    std::vector<float> inputBuffer;
-    int inputWritePos = 0;
-    int samplesUntilNextFrame = 0;
+        // Set while the sliding-DFT engine is selected
+        std::shared_ptr<const SlidingDFT::Plan> slidingPlan;
 
+        // Set while the reassignment engine is selected
+        std::shared_ptr<const Reassignment::Plan> reassignmentPlan;
+    };
+
+    // A Config as published, with the readers holding it
+    struct PublishedConfig
+    {
+        explicit PublishedConfig(Config&& c) : config(std::move(c)) {}
+
+        const Config config;
+        mutable std::atomic<int> readers{0};
+    };
+
+    // Registers the calling thread as a reader of the current Config for its
+    // lifetime
+    class ConfigReader
+    {
+    public:
+        explicit ConfigReader(const SpectralAnalyser& owner) noexcept;
+        ~ConfigReader();
+
+        const Config* operator->() const noexcept { return &published->config; }
+        const Config& operator*() const noexcept { return published->config; }
+
+    private:
+        const PublishedConfig* published;
+
+        JUCE_DECLARE_NON_COPYABLE(ConfigReader)
+    };
+
+    struct SlotInfo
+    {
+        BinLayout layout;
+        bool hasStereo = false;
+        int hop = 0;
+        int spacing = 0;
+    };
+
+    // A consumer cursor: the slot it reads next, plus a flag while that slot
+    // is acquired. The writer only ever moves a cursor that isn't held.
+    static constexpr uint32_t heldFlag = 0x80000000u;
+
+    static int positionOf(uint32_t cursor) noexcept { return static_cast<int>(cursor & ~heldFlag); }
+    static bool isHeld(uint32_t cursor) noexcept    { return (cursor & heldFlag) != 0; }
+
+    // Writer side; callers hold configLock
+    std::unique_ptr<Config> copyCurrentConfig() const;
+    void publish(std::unique_ptr<Config> newConfig);
+    void reclaimRetiredConfigs();
+
+    static void applyFFTSize(Config& config, int fftSize);
+    static void updateHopSize(Config& config);
+    static void selectWindow(Config& config);
+    static void updateEnginePlans(Config& config);
+    static BinLayout getFFTLayout(const Config& config) noexcept;
+
+    // The engine process() will use for the mono frames: the selected one,
+    // or the FFT while Nebula needs the stereo outputs
+    Engine getActiveEngine(const Config& config) const noexcept;
+
+    // spacing is the input samples since the previous analysed frame
+    bool analyseFrame(const Config& config, Engine engine, int spacing,
+                      const CaptureRing& input, const CaptureRing::Region& region);
+    void processMonoFrame(const Config& config, int slot, const CaptureRing& input, const CaptureRing::Region& region);
+    void processStereoFrame(const Config& config, int slot, const CaptureRing& input, const CaptureRing::Region& region);
+    void processZoomFrame(const BandZoom::Plan& plan, int slot);
+    void processMultiResolutionFrame(const MultiResolution::Plan& plan, int slot);
+    void processSlidingFrame(const SlidingDFT::Plan& plan, int slot);
+    void processReassignedFrame(const Reassignment::Plan& plan, int slot);
+
+    // Adds a window of input to the reassignment; true once a frame is due
+    bool pushToReassignment(const Config& config, const CaptureRing& input, const CaptureRing::Region& region);
+
+    // Brings the streaming engine's state in line with the Config, or clears
+    // it outright
+    void prepareEngine(const Config& config, Engine engine) noexcept;
+    void resetEngine(Engine engine) noexcept;
+
+    // Input samples between frames for the given engine
+    static int getHopSize(const Config& config, Engine engine) noexcept;
+
+    // Whether the engine keeps its own input history, so a frame needs only
+    // a hop of new input rather than a whole window
+    static bool isStreaming(Engine engine) noexcept;
+
+    // Feeds a hop of input to the streaming engine
+    void pushToEngine(const Config& config, Engine engine,
+                      const CaptureRing& input, const CaptureRing::Region& region);
+
+    bool makeRoomForFrame(int writeIdx) noexcept;
+    int acquireSlot(std::atomic<uint32_t>& cursor, bool stereoOnly, const BinLayout& layout) noexcept;
+    void releaseSlot(std::atomic<uint32_t>& cursor) noexcept;
+    void fillView(int slot, FrameView& view) const noexcept;
+
+    float* getPlane(int slot, Plane plane) const noexcept
+    {
+        return frameSlab + (static_cast<size_t>(slot) * numPlanes + static_cast<size_t>(plane)) * planeStride;
+    }
+
+    std::atomic<PublishedConfig*> currentConfig{nullptr};
+
+    // Readers between loading currentConfig and counting themselves on it,
+    // a few instructions' time
+    mutable std::atomic<int> registeringReaders{0};
+
+    // Replaced Configs that were still held at the last change, at most one
+    // per reader thread
+    std::vector<std::unique_ptr<PublishedConfig>> retiredConfigs;
+    juce::CriticalSection configLock;
+
+    std::atomic<bool> stereoOutputsEnabled{false};
+
+    std::atomic<uint64_t> analysedFrames{0};
+    std::atomic<uint64_t> droppedFrames{0};
+    std::atomic<uint64_t> droppedSamples{0};
+    std::atomic<int> lastBacklogFrames{0};
+    std::atomic<uint64_t> overrunFrames{0};
+
+    // Scratch for the thread running process(), sized for maxFFTSize.
+    // Real path: fftSize reals in, interleaved complex out (2 * fftSize)
     std::vector<float> fftWorkBuffer;
 
-    static constexpr int maxFrames = 512;
-    static constexpr int maxBins = 8192 / 2 + 1;
+    // Packed path: L + iR in, full complex spectrum out
+    std::vector<juce::dsp::Complex<float>> packedInput, spectrum;
+
+    // Engine state, continuous across process() calls while the same engine
+    // stays in use
+    BandZoom zoom;
+    MultiResolution multiResolution;
+    SlidingDFT slidingDFT;
+    Reassignment reassignment;
+    Engine streamedEngine = Engine::fft;
+
+    // maxFrames slots of numPlanes planes each, all in one block
+    juce::HeapBlock<float> frameSlabStorage;
+    float* frameSlab = nullptr;
+    std::array<SlotInfo, maxFrames> slotInfo;
 
-    std::vector<std::vector<float>> frameBuffer;
     std::atomic<int> frameWritePos{0};
-    std::atomic<int> frameReadPos{0};
+    std::atomic<uint32_t> monoCursor{0};
+    std::atomic<uint32_t> stereoCursor{0};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralAnalyser)
 };
@@ -0,0 +1,94 @@
+#include "SpectrogramHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void SpectrogramHistory::prepare(double newSampleRate)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (juce::exactlyEqual(newSampleRate, sampleRate))
+        return;
+
+    sampleRate = newSampleRate;
+
+    // The frames held so far were timed at the old rate
+    if (layout.numBins > 0)
+        restartLocked(layout, hop);
+}
+
+void SpectrogramHistory::setFormat(DbFormat::Type newFormat)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (newFormat == format)
+        return;
+
+    format = newFormat;
+
+    // Give back what a wider format grew to, or switching to a narrower one
+    // wouldn't save anything
+    std::vector<uint8_t>().swap(storage);
+
+    if (layout.numBins > 0)
+        restartLocked(layout, hop);
+}
+
+void SpectrogramHistory::append(const float* frameDb, const BinLayout& frameLayout, int frameHop, int frameSpacing)
+{
+    jassert(frameLayout.numBins > 0 && frameHop > 0);
+
+    const juce::ScopedLock sl(lock);
+
+    if (frameLayout != layout || frameHop != hop)
+        restartLocked(frameLayout, frameHop);
+
+    auto* dest = storage.data() + static_cast<size_t>(written % capacity) * frameBytes;
+    DbFormat::encode(format, frameDb, dest, layout.numBins);
+    ++written;
+
+    // No more copies than the history holds, so the first is never written over
+    const int copies = juce::jlimit(1, capacity, frameSpacing / frameHop);
+
+    for (int i = 1; i < copies; ++i)
+    {
+        std::memcpy(storage.data() + static_cast<size_t>(written % capacity) * frameBytes, dest, frameBytes);
+        ++written;
+    }
+}
+
+SpectrogramHistory::Info SpectrogramHistory::getInfo() const noexcept
+{
+    const juce::ScopedLock sl(lock);
+
+    Info info;
+    info.generation = generation;
+    info.layout = layout;
+    info.hop = hop;
+    info.sampleRate = sampleRate;
+    info.format = format;
+    info.frameBytes = frameBytes;
+    info.capacity = capacity;
+    info.end = written;
+    return info;
+}
+
+void SpectrogramHistory::restartLocked(const BinLayout& newLayout, int newHop)
+{
+    layout = newLayout;
+    hop = newHop;
+    frameBytes = static_cast<size_t>(layout.numBins) * static_cast<size_t>(DbFormat::getBytesPerValue(format));
+
+    const double framesPerSecond = (sampleRate > 0.0 ? sampleRate : 44100.0) / hop;
+    const auto maxFrames = static_cast<int>(maxBytes / frameBytes);
+    capacity = juce::jlimit(1, maxFrames, static_cast<int>(std::ceil(seconds * framesPerSecond)));
+
+    // Only grows, so going back to an earlier setting doesn't allocate again
+    const size_t needed = static_cast<size_t>(capacity) * frameBytes;
+
+    if (storage.size() < needed)
+        storage.resize(needed);
+
+    written = 0;
+    ++generation;
+}
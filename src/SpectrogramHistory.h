@@ -0,0 +1,119 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "BinLayout.h"
+#include "DbFormat.h"
+#include <cstdint>
+#include <vector>
+
+// The scrolling spectrogram's history, owned by the processor so it outlives
+// the editor. The analysis worker appends every mono frame as it's analysed,
+// whether or not an editor is open; the editor is a view that copies out the
+// frames it shows, so it opens with the full history and can redraw it at
+// any size.
+//
+// The history is sized in time: seconds of frames at the hop they were
+// analysed with, capped at maxBytes of storage for very short hops. Frames
+// are kept in a DbFormat, so a history in half floats or 16-bit codes takes
+// half the memory of one in floats and is copied to the texture as it is.
+// Frames are numbered from 0 since the history last restarted, which it does
+// when the frames' layout, hop or format changes (a new FFT size or engine);
+// each restart bumps the generation, so a view can tell its copy is stale.
+//
+// The worker appends under a lock that a reader only holds while it copies
+// a few frames at a time, so neither side waits long.
+class SpectrogramHistory
+{
+public:
+    static constexpr double seconds = 30.0;
+
+    // At a 4-sample hop this still holds several seconds of floats
+    static constexpr size_t maxBytes = 64 * 1024 * 1024;
+
+    // How a reader finds its way around the frames
+    struct Info
+    {
+        uint64_t generation = 0;
+        BinLayout layout;
+        int hop = 0;                // input samples per frame
+        double sampleRate = 0.0;
+        DbFormat::Type format = DbFormat::Type::float32;
+        size_t frameBytes = 0;      // layout.numBins values in format
+        int capacity = 0;           // frames held at most
+        int64_t end = 0;            // one past the newest frame
+
+        int64_t getOldest() const noexcept { return juce::jmax(static_cast<int64_t>(0), end - capacity); }
+    };
+
+    SpectrogramHistory() = default;
+
+    // Sets the rate the hop is measured at. A new rate restarts the history;
+    // the same one keeps it. Not while append() may be running.
+    void prepare(double sampleRate);
+
+    // Sets how frames are stored. A new format restarts the history and
+    // frees the storage the old one used; the same one keeps it.
+    void setFormat(DbFormat::Type newFormat);
+
+    // Writer side, one thread at a time. May allocate when the layout or hop
+    // changes. A frame spaced more than a hop after the last, because the
+    // analyser decimated a backlog, also fills the places of the frames left
+    // out, so the history stays one hop per frame.
+    void append(const float* frameDb, const BinLayout& layout, int hop, int spacing);
+
+    Info getInfo() const noexcept;
+
+    // Calls callback(index, frame) for each frame in [first, end) that the
+    // history still holds in info's generation, oldest first, with frame
+    // pointing at its info.frameBytes in info.format, and returns
+    // the index after the last one visited: less than end if the history
+    // restarted meanwhile.
+    template <typename Callback>
+    int64_t read(const Info& info, int64_t first, int64_t end, Callback&& callback) const
+    {
+        constexpr int framesPerLock = 32;
+
+        while (first < end)
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (generation != info.generation)
+                break;
+
+            first = juce::jmax(first, getOldestLocked());
+            const int64_t stop = juce::jmin(end, written, first + framesPerLock);
+
+            for (; first < stop; ++first)
+                callback(first, getFrameLocked(first));
+
+            if (stop < end && stop == written)
+                break;
+        }
+
+        return first;
+    }
+
+private:
+    void restartLocked(const BinLayout& newLayout, int newHop);
+
+    int64_t getOldestLocked() const noexcept { return juce::jmax(static_cast<int64_t>(0), written - capacity); }
+
+    const uint8_t* getFrameLocked(int64_t index) const noexcept
+    {
+        return storage.data() + static_cast<size_t>(index % capacity) * frameBytes;
+    }
+
+    juce::CriticalSection lock;
+    std::vector<uint8_t> storage;
+
+    uint64_t generation = 0;
+    BinLayout layout;
+    int hop = 0;
+    double sampleRate = 0.0;
+    DbFormat::Type format = DbFormat::Type::float32;
+    size_t frameBytes = 0;
+    int capacity = 0;
+    int64_t written = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramHistory)
+};
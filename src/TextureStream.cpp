@@ -0,0 +1,195 @@
+#include "TextureStream.h"
+
+using namespace juce::gl;
+
+TextureStream::TextureStream(size_t capacityBytes, int maxRecordsToUse)
+    : capacity(capacityBytes), maxRecords(maxRecordsToUse)
+{
+    jassert(capacity > 0 && maxRecords > 0);
+    records.resize(static_cast<size_t>(maxRecords));
+}
+
+TextureStream::~TextureStream()
+{
+    // The GL resources go with the context
+    jassert(memory == nullptr);
+}
+
+void TextureStream::create()
+{
+    jassert(!ready.load());
+
+    const bool clientOnly = juce::SystemStats::getEnvironmentVariable("SPECTROGRAM_GL_STREAMING", {})
+                                .trim().toLowerCase() == "client";
+
+    if (!clientOnly && glBufferStorage != nullptr && glMapBufferRange != nullptr && glFenceSync != nullptr)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const auto size = static_cast<GLsizeiptr>(capacity);
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+        memory = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (memory == nullptr)
+        {
+            DBG("TextureStream: persistent mapping failed, uploading from client memory");
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+    }
+
+    if (memory == nullptr)
+    {
+        clientMemory.resize(capacity);
+        memory = clientMemory.data();
+    }
+
+    consumedHead = 0;
+    numFences = 0;
+    publishedHead.store(0, std::memory_order_relaxed);
+    releasedTail.store(0, std::memory_order_relaxed);
+
+    generation.fetch_add(1, std::memory_order_relaxed);
+    ready.store(true, std::memory_order_release);
+}
+
+void TextureStream::release()
+{
+    ready.store(false, std::memory_order_release);
+
+    // Deleting a fence or buffer the GPU still uses is deferred by the driver
+    for (int i = 0; i < numFences; ++i)
+        glDeleteSync(fences[i].fence);
+
+    numFences = 0;
+
+    if (buffer != 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+    std::vector<uint8_t>().swap(clientMemory);
+    memory = nullptr;
+}
+
+int64_t TextureStream::beginUpload() noexcept
+{
+    if (!ready.load(std::memory_order_relaxed))
+        return consumedHead;
+
+    retireFences();
+
+    // The GPU is a long way behind; leave the rest queued for later
+    if (numFences == maxPendingFences)
+        return consumedHead;
+
+    const auto head = publishedHead.load(std::memory_order_acquire);
+
+    if (head != consumedHead && buffer != 0)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+
+    return head;
+}
+
+void TextureStream::endUpload(int64_t head) noexcept
+{
+    if (buffer == 0)
+    {
+        // The uploads copied from client memory before returning
+        releasedTail.store(head, std::memory_order_release);
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    fences[numFences++] = { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), head };
+}
+
+void TextureStream::retireFences() noexcept
+{
+    int retired = 0;
+
+    for (; retired < numFences; ++retired)
+    {
+        const auto status = glClientWaitSync(fences[retired].fence, 0, 0);
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+
+        glDeleteSync(fences[retired].fence);
+        releasedTail.store(fences[retired].end, std::memory_order_release);
+    }
+
+    std::copy(fences + retired, fences + numFences, fences);
+    numFences -= retired;
+}
+
+void* TextureStream::allocate(const Region& region, size_t numBytes) noexcept
+{
+    if (!ready.load(std::memory_order_acquire))
+        return nullptr;
+
+    // A new stream starts empty
+    const auto currentGeneration = generation.load(std::memory_order_relaxed);
+
+    if (currentGeneration != producerGeneration)
+    {
+        producerGeneration = currentGeneration;
+        writeHead = 0;
+        writeOffset = 0;
+    }
+
+    // Records start 4-byte aligned, as glTexSubImage2D reads rows by default
+    numBytes = (numBytes + 3) & ~static_cast<size_t>(3);
+
+    if (numBytes == 0 || numBytes >= capacity)
+        return nullptr;
+
+    const auto tail = releasedTail.load(std::memory_order_acquire);
+
+    if (writeHead - tail >= maxRecords)
+        return nullptr;
+
+    // The bytes in use run from the oldest unreleased record to writeOffset,
+    // possibly wrapping. Writing never catches up with that record exactly,
+    // so an offset equal to it always means empty.
+    size_t offset = 0;
+
+    if (tail != writeHead)
+    {
+        const auto oldest = records[static_cast<size_t>(tail % maxRecords)].offset;
+
+        if (writeOffset > oldest)
+        {
+            if (writeOffset + numBytes <= capacity)
+                offset = writeOffset;
+            else if (numBytes >= oldest)
+                return nullptr;
+        }
+        else if (writeOffset + numBytes < oldest)
+        {
+            offset = writeOffset;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    records[static_cast<size_t>(writeHead % maxRecords)] = { offset, numBytes, region };
+    ++writeHead;
+    writeOffset = offset + numBytes;
+
+    return static_cast<uint8_t*>(memory) + offset;
+}
+
+void TextureStream::publish() noexcept
+{
+    publishedHead.store(writeHead, std::memory_order_release);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <juce_opengl/juce_opengl.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Streams texture updates from the message thread to the GL thread through
+// staging memory the GL thread can copy from asynchronously.
+//
+// The staging memory is a ring in one pixel buffer object, mapped once and
+// kept mapped (GL 4.4 or ARB_buffer_storage: persistent, coherent). The
+// message thread writes pixels straight into it and publishes a record of
+// where they go; the GL thread only issues glTexSubImage2D from the buffer,
+// which the driver turns into a DMA instead of copying from client memory
+// before it returns. A fence after each batch tells the GL thread when the
+// GPU has finished reading, and only then is that part of the ring handed
+// back to the message thread, so pixels are never overwritten in flight.
+//
+// Without buffer storage (or with SPECTROGRAM_GL_STREAMING=client) the ring
+// is plain memory and uploads come from client memory as before, which
+// releases the ring straight away.
+//
+// One producer and one consumer, lock-free. create() and release() run on
+// the GL thread as the context comes and goes; the producer sees nothing
+// until create() has finished, and JUCE holds the message thread while a
+// context shuts down.
+class TextureStream
+{
+public:
+    // Where an update goes in its texture, and the texture's whole size and
+    // pixel format (the consumer's own tag), so the consumer can tell when it
+    // has to be reallocated
+    struct Region
+    {
+        int imageWidth = 0, imageHeight = 0;
+        int x = 0, y = 0, width = 0, height = 0;
+        int format = 0;
+    };
+
+    TextureStream(size_t capacityBytes, int maxRecords);
+    ~TextureStream();
+
+    // GL thread, with the context current
+    void create();
+    void release();
+
+    // Uploads everything published since the last call: calls
+    // upload(region, pixels) for each run of updates, merging those that
+    // continue each other (consecutive rows, say), with pixels ready to be
+    // passed to glTexSubImage2D: an offset into the bound buffer, or client
+    // memory.
+    template <typename Upload>
+    void upload(Upload&& uploadRun)
+    {
+        const auto head = beginUpload();
+
+        if (head == consumedHead)
+            return;
+
+        while (consumedHead < head)
+        {
+            const auto& first = records[static_cast<size_t>(consumedHead % maxRecords)];
+            auto run = first.region;
+            auto runEnd = first.offset + first.size;
+            ++consumedHead;
+
+            for (; consumedHead < head; ++consumedHead)
+            {
+                const auto& next = records[static_cast<size_t>(consumedHead % maxRecords)];
+
+                if (!continues(run, runEnd, next))
+                    break;
+
+                run.height += next.region.height;
+                runEnd += next.size;
+            }
+
+            uploadRun(run, getPixels(first.offset));
+        }
+
+        endUpload(head);
+    }
+
+    // Message thread. Returns room for numBytes of pixels for region, or
+    // nullptr when there's no context yet or the GPU hasn't caught up; the
+    // pixels go once publish() is called. Pixels are write-only: the memory
+    // may be uncached.
+    void* allocate(const Region& region, size_t numBytes) noexcept;
+    void publish() noexcept;
+
+    // Message thread: changes whenever the stream is created again, when
+    // anything sent before is lost with the old context; 0 with no context
+    uint64_t getGeneration() const noexcept { return ready.load(std::memory_order_acquire) ? generation.load(std::memory_order_relaxed) : 0; }
+
+private:
+    struct Record
+    {
+        size_t offset = 0, size = 0;
+        Region region;
+    };
+
+    struct PendingFence
+    {
+        GLsync fence = nullptr;
+        int64_t end = 0;                // records up to here are free once it signals
+    };
+
+    static constexpr int maxPendingFences = 8;
+
+    // Returns the records to upload up to, consumedHead for none
+    int64_t beginUpload() noexcept;
+    void endUpload(int64_t head) noexcept;
+    void retireFences() noexcept;
+
+    const void* getPixels(size_t offset) const noexcept
+    {
+        // With the buffer bound, the pointer argument is an offset into it
+        return buffer != 0 ? reinterpret_cast<const void*>(offset) : static_cast<const uint8_t*>(memory) + offset;
+    }
+
+    static bool continues(const Region& run, size_t runEnd, const Record& next) noexcept
+    {
+        return next.offset == runEnd
+            && next.region.imageWidth == run.imageWidth && next.region.imageHeight == run.imageHeight
+            && next.region.format == run.format
+            && next.region.x == run.x && next.region.width == run.width
+            && next.region.y == run.y + run.height;
+    }
+
+    const size_t capacity;
+    const int maxRecords;
+    std::vector<Record> records;
+
+    // GL thread
+    GLuint buffer = 0;
+    std::vector<uint8_t> clientMemory;
+    int64_t consumedHead = 0;
+    PendingFence fences[maxPendingFences];
+    int numFences = 0;
+
+    // Set up by the GL thread before ready
+    void* memory = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<uint64_t> generation{0};
+
+    // Records published by the producer, and those whose pixels the GPU has
+    // finished with
+    std::atomic<int64_t> publishedHead{0};
+    std::atomic<int64_t> releasedTail{0};
+
+    // Message thread
+    uint64_t producerGeneration = 0;
+    int64_t writeHead = 0;
+    size_t writeOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(TextureStream)
+};
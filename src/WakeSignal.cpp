@@ -0,0 +1,130 @@
+#include "WakeSignal.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+ #include <ctime>
+#endif
+
+// A counting OS semaphore. Posting never blocks on any of these.
+struct WakeSignal::Semaphore
+{
+#if JUCE_WINDOWS
+    Semaphore()  { handle = CreateSemaphoreW(nullptr, 0, 1 << 30, nullptr); }
+    ~Semaphore() { CloseHandle(handle); }
+
+    void post() noexcept { ReleaseSemaphore(handle, 1, nullptr); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        return WaitForSingleObject(handle, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs)) == WAIT_OBJECT_0;
+    }
+
+    HANDLE handle;
+#elif JUCE_MAC || JUCE_IOS
+    // Unnamed POSIX semaphores aren't implemented on Apple platforms
+    Semaphore()  { handle = dispatch_semaphore_create(0); }
+    ~Semaphore() { dispatch_release(handle); }
+
+    void post() noexcept { dispatch_semaphore_signal(handle); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        const auto timeout = timeoutMs < 0 ? DISPATCH_TIME_FOREVER
+                                           : dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(timeoutMs) * 1000000);
+        return dispatch_semaphore_wait(handle, timeout) == 0;
+    }
+
+    dispatch_semaphore_t handle;
+#else
+    Semaphore()  { sem_init(&handle, 0, 0); }
+    ~Semaphore() { sem_destroy(&handle); }
+
+    void post() noexcept { sem_post(&handle); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        if (timeoutMs < 0)
+        {
+            while (sem_wait(&handle) != 0)
+                if (errno != EINTR)
+                    return false;
+
+            return true;
+        }
+
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (sem_timedwait(&handle, &deadline) != 0)
+            if (errno != EINTR)
+                return false;
+
+        return true;
+    }
+
+    sem_t handle;
+#endif
+};
+
+WakeSignal::WakeSignal()
+    : semaphore(std::make_unique<Semaphore>())
+{
+}
+
+WakeSignal::~WakeSignal() = default;
+
+void WakeSignal::signal() noexcept
+{
+    int old = state.load(std::memory_order_relaxed);
+
+    do
+    {
+        if (old > 0)
+            return;     // already signalled
+    }
+    while (!state.compare_exchange_weak(old, old + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    // The waiter is asleep (or about to be): hand it a token
+    if (old < 0)
+        semaphore->post();
+}
+
+bool WakeSignal::wait(int timeoutMs) noexcept
+{
+    // 1 -> 0 consumes a pending signal; 0 -> -1 announces that we're sleeping
+    if (state.fetch_sub(1, std::memory_order_acq_rel) > 0)
+        return true;
+
+    if (semaphore->wait(timeoutMs))
+        return true;
+
+    // Timed out. Withdraw, unless a signal() has already claimed us and is
+    // about to post, in which case that token has to be consumed.
+    int old = state.load(std::memory_order_relaxed);
+
+    while (old < 0)
+        if (state.compare_exchange_weak(old, old + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return false;
+
+    semaphore->wait(-1);
+    return true;
+}
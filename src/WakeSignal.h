@@ -0,0 +1,36 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <memory>
+
+// Wakes a single waiting thread from any thread, including the audio thread.
+//
+// juce::WaitableEvent takes a mutex in signal(), so the audio thread could
+// block on a waiter that holds it. Here the common paths are a single atomic
+// operation: signalling while the waiter is busy just sets a flag, and only a
+// waiter that actually went to sleep costs a semaphore post, which doesn't
+// block either.
+class WakeSignal
+{
+public:
+    WakeSignal();
+    ~WakeSignal();
+
+    // Wakes the waiter, or makes its next wait() return straight away.
+    // Signals don't accumulate: any number before a wait() count as one.
+    void signal() noexcept;
+
+    // Waiter thread only. Returns true if signalled, false on timeout
+    // (a negative timeout waits forever).
+    bool wait(int timeoutMs) noexcept;
+
+private:
+    // 1 = signalled, 0 = idle, -1 = waiter asleep on the semaphore
+    std::atomic<int> state{0};
+
+    struct Semaphore;
+    std::unique_ptr<Semaphore> semaphore;
+
+    JUCE_DECLARE_NON_COPYABLE(WakeSignal)
+};
@@ -0,0 +1,136 @@
+#include "WindowBank.h"
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace
+{
+    constexpr double twoPi = 2.0 * juce::MathConstants<double>::pi;
+
+    // Sum of a[k] * cos(2 pi k x) with alternating signs, x in [0, 1]
+    double cosineSum(const WindowBank::CosineTerms& terms, double x) noexcept
+    {
+        double w = 0.0;
+        for (int k = 0; k < terms.numTerms; ++k)
+            w += ((k & 1) != 0 ? -terms.a[k] : terms.a[k]) * std::cos(twoPi * static_cast<double>(k) * x);
+        return w;
+    }
+
+    // Modified Bessel function of the first kind, order zero
+    double besselI0(double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        const double halfX = 0.5 * x;
+
+        for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+        {
+            const double t = halfX / static_cast<double>(k);
+            term *= t * t;
+            sum += term;
+        }
+        return sum;
+    }
+
+    double windowValue(WindowBank::Type type, double x) noexcept
+    {
+        if (type == WindowBank::Type::kaiser)
+        {
+            const double r = 2.0 * x - 1.0;
+            return besselI0(WindowBank::kaiserBeta * std::sqrt(juce::jmax(0.0, 1.0 - r * r)))
+                 / besselI0(WindowBank::kaiserBeta);
+        }
+
+        return cosineSum(WindowBank::getCosineTerms(type), x);
+    }
+
+    std::shared_ptr<const WindowBank::Table> buildTable(WindowBank::Type type, int size)
+    {
+        auto table = std::make_shared<WindowBank::Table>();
+        table->type = type;
+        table->size = size;
+
+        // One extra cache line so the data can start on a 64-byte boundary
+        table->storage.malloc(static_cast<size_t>(size) + 16);
+        auto* data = juce::snapPointerToAlignment(table->storage.get(), 64);
+
+        double sum = 0.0, sumOfSquares = 0.0;
+        const double denominator = static_cast<double>(juce::jmax(1, size - 1));
+
+        for (int i = 0; i < size; ++i)
+        {
+            const double w = windowValue(type, static_cast<double>(i) / denominator);
+            data[i] = static_cast<float>(w);
+            sum += w;
+            sumOfSquares += w * w;
+        }
+
+        table->data = data;
+        table->coherentGain = static_cast<float>(sum / size);
+        table->enbw = static_cast<float>(size * sumOfSquares / (sum * sum));
+        return table;
+    }
+
+    // At most five types times the eight FFT sizes, well under a megabyte,
+    // so tables are kept for the life of the process once built
+    class TableCache
+    {
+    public:
+        static TableCache& getInstance()
+        {
+            static TableCache cache;
+            return cache;
+        }
+
+        std::shared_ptr<const WindowBank::Table> get(WindowBank::Type type, int size)
+        {
+            const juce::ScopedLock sl(lock);
+
+            auto& table = tables[{ type, size }];
+            if (table == nullptr)
+                table = buildTable(type, size);
+
+            return table;
+        }
+
+    private:
+        juce::CriticalSection lock;
+        std::map<std::pair<WindowBank::Type, int>, std::shared_ptr<const WindowBank::Table>> tables;
+    };
+}
+
+const char* WindowBank::getName(Type type) noexcept
+{
+    switch (type)
+    {
+        case Type::hann:           return "Hann";
+        case Type::blackmanHarris: return "Blackman-Harris";
+        case Type::kaiser:         return "Kaiser";
+        case Type::flatTop:        return "Flat-top";
+        case Type::nuttall:        return "Nuttall";
+    }
+    return "";
+}
+
+WindowBank::CosineTerms WindowBank::getCosineTerms(Type type) noexcept
+{
+    switch (type)
+    {
+        case Type::hann:           return { 2, { 0.5, 0.5 } };
+        case Type::blackmanHarris: return { 4, { 0.35875, 0.48829, 0.14128, 0.01168 } };
+        case Type::kaiser:         return {};
+
+        // Amplitude-accurate to about 0.01 dB anywhere within a bin
+        case Type::flatTop:        return { 5, { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 } };
+
+        case Type::nuttall:        return { 4, { 0.355768, 0.487396, 0.144232, 0.012604 } };
+    }
+
+    jassertfalse;
+    return {};
+}
+
+std::shared_ptr<const WindowBank::Table> WindowBank::get(Type type, int size)
+{
+    jassert(size > 0);
+    return TableCache::getInstance().get(type, size);
+}
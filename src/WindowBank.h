@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <memory>
+
+// Process-wide cache of analysis window tables, keyed by (type, size). Each
+// table is built once on first use, with its correction factors alongside,
+// and is never modified afterwards, so every analyser in every plugin
+// instance shares the same copy and switching windows is a pointer swap.
+//
+// Tables are symmetric (the denominator is size - 1), matching the windows
+// the analyser has always used.
+namespace WindowBank
+{
+    enum class Type { hann, blackmanHarris, kaiser, flatTop, nuttall };
+
+    // Shape parameter of the Kaiser window; about -90 dB sidelobes
+    inline constexpr double kaiserBeta = 9.0;
+
+    const char* getName(Type type) noexcept;
+
+    // The window as a sum of cosines,
+    // w(x) = a[0] - a[1] cos(2 pi x) + a[2] cos(4 pi x) - ..., x in [0, 1].
+    // Kaiser isn't one, and has numTerms == 0.
+    struct CosineTerms
+    {
+        int numTerms = 0;
+        double a[5] = {};
+    };
+
+    CosineTerms getCosineTerms(Type type) noexcept;
+
+    struct Table
+    {
+        Type type = Type::hann;
+        int size = 0;
+
+        // Mean of the window, i.e. the amplitude a bin-centred sinusoid keeps
+        float coherentGain = 1.0f;
+
+        // Equivalent noise bandwidth in bins: size * sum(w^2) / sum(w)^2
+        float enbw = 1.0f;
+
+        // size samples, 64-byte aligned
+        const float* data = nullptr;
+
+        juce::HeapBlock<float> storage;
+    };
+
+    // Builds the table on the first request for this (type, size) and hands
+    // out the shared copy afterwards. Takes a lock, so not for the audio
+    // thread; the analyser calls it while building a new Config.
+    std::shared_ptr<const Table> get(Type type, int size);
+}
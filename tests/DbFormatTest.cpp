@@ -0,0 +1,171 @@
+// Checks the dB storage formats against the float path: every format's
+// colour-map position within a 255th of float's, and the half conversions
+// against a reference over every input.
+
+#include "DbFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const char* what, double got, double limit)
+    {
+        if (!condition)
+        {
+            std::printf("FAIL: %s (%g against %g)\n", what, got, limit);
+            ++failures;
+        }
+    }
+
+    // What the fragment shader does with a dB value
+    float colourPosition(float db, float dbFloor, float dbCeiling)
+    {
+        return std::clamp((db - dbFloor) / (dbCeiling - dbFloor), 0.0f, 1.0f);
+    }
+
+    // The nearest half to x, ties to even, as a float: worked out in double
+    // from the half's quantum at x's magnitude rather than from its bits
+    float referenceHalf(float x)
+    {
+        if (std::isnan(x))
+            return x;
+
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        const double magnitude = std::fabs(static_cast<double>(x));
+        const int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127;
+
+        // A half has 11 significant bits, and no quantum below 2^-24. Adding
+        // and taking away 2^52 rounds to a whole number, ties to even.
+        const int quantumExponent = std::max(exponent - 10, -24);
+        const auto quantumBits = static_cast<uint64_t>(quantumExponent + 1023) << 52;
+        double quantum;
+        std::memcpy(&quantum, &quantumBits, sizeof(quantum));
+
+        const double steps = magnitude / quantum;
+        const double rounded = steps < 0x1p52 ? ((steps + 0x1p52) - 0x1p52) * quantum : magnitude;
+        const double result = rounded > 65504.0 ? HUGE_VAL : rounded;
+
+        return static_cast<float>(std::signbit(x) ? -result : result);
+    }
+
+    bool sameFloat(float a, float b)
+    {
+        if (std::isnan(a) || std::isnan(b))
+            return std::isnan(a) && std::isnan(b);
+
+        uint32_t aBits, bBits;
+        std::memcpy(&aBits, &a, sizeof(aBits));
+        std::memcpy(&bBits, &b, sizeof(bBits));
+        return aBits == bBits;
+    }
+
+    void testColourPositions()
+    {
+        // -140 .. +20 dB in hundredths, a 63rd of an 8-bit step
+        std::vector<float> db;
+
+        for (int i = -14000; i <= 2000; ++i)
+            db.push_back(static_cast<float>(i) * 0.01f);
+
+        const int num = static_cast<int>(db.size());
+        std::vector<unsigned char> stored(db.size() * sizeof(float));
+        std::vector<float> decoded(db.size());
+
+        struct Case
+        {
+            DbFormat::Type type;
+            const char* name;
+            float minRangeDb;
+        };
+
+        // 8-bit codes are 0.63 dB apart, a 255th of the colour map only
+        // when floor to ceiling spans 80 dB or more
+        const Case cases[] = { { DbFormat::Type::float16, "float16 colour position", 10.0f },
+                               { DbFormat::Type::unorm16, "unorm16 colour position", 10.0f },
+                               { DbFormat::Type::unorm8,  "unorm8 colour position",  80.0f } };
+
+        for (const auto& c : cases)
+        {
+            DbFormat::encode(c.type, db.data(), stored.data(), num);
+            DbFormat::decode(c.type, stored.data(), decoded.data(), num);
+
+            // Every floor and ceiling the sliders offer
+            float worst = 0.0f;
+
+            for (int dbFloor = -120; dbFloor <= -20; ++dbFloor)
+            {
+                for (int dbCeiling = -30; dbCeiling <= 10; ++dbCeiling)
+                {
+                    if (static_cast<float>(dbCeiling - dbFloor) < c.minRangeDb)
+                        continue;
+
+                    const auto f = static_cast<float>(dbFloor), g = static_cast<float>(dbCeiling);
+
+                    for (size_t i = 0; i < db.size(); ++i)
+                        worst = std::max(worst, std::fabs(colourPosition(decoded[i], f, g) - colourPosition(db[i], f, g)));
+                }
+            }
+
+            std::printf("%s: worst %.3f / 255\n", c.name, static_cast<double>(worst * 255.0f));
+            // Give or take the float rounding of the comparison itself
+            expect(worst <= 1.0f / 255.0f + 1.0e-6f, c.name, static_cast<double>(worst), 1.0 / 255.0);
+        }
+
+        // float32 is the float path
+        DbFormat::encode(DbFormat::Type::float32, db.data(), stored.data(), num);
+        DbFormat::decode(DbFormat::Type::float32, stored.data(), decoded.data(), num);
+        expect(std::equal(db.begin(), db.end(), decoded.begin()), "float32 round trip", 0.0, 0.0);
+    }
+
+    void testHalfConversions()
+    {
+        // Every half survives the trip through float
+        int badHalves = 0;
+
+        for (uint32_t h = 0; h <= 0xffffu; ++h)
+        {
+            const auto half = static_cast<uint16_t>(h);
+            const float value = DbFormat::halfToFloat(half);
+            const uint16_t back = DbFormat::floatToHalf(value);
+
+            if (std::isnan(value) ? (back & 0x7fffu) <= 0x7c00u : back != half)
+                ++badHalves;
+        }
+
+        expect(badHalves == 0, "half -> float -> half", badHalves, 0);
+
+        // Every float rounds to the nearest half
+        int badFloats = 0;
+        uint32_t bits = 0;
+
+        do
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            if (!sameFloat(DbFormat::halfToFloat(DbFormat::floatToHalf(value)), referenceHalf(value)))
+                ++badFloats;
+        }
+        while (++bits != 0);
+
+        expect(badFloats == 0, "float -> half -> float", badFloats, 0);
+    }
+}
+
+int main()
+{
+    testColourPositions();
+    testHalfConversions();
+
+    if (failures != 0)
+        return 1;
+
+    std::printf("All DbFormat tests passed\n");
+    return 0;
+}